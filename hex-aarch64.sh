@@ -2,10 +2,12 @@
 # Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
 #
 
-files=("src/hex.c" "src/stream.c" "src/app.c" "src/path.c" "src/main.c")
+files=("src/hex.c" "src/stream.c" "src/app.c" "src/path.c" "src/record.c"
+       "src/digest.c" "src/freq.c" "src/chunk.c" "src/edit.c"
+       "src/find.c" "src/main.c")
 output="hex-aarch64.elf"
 
-aarch64-linux-gnu-gcc ${files[@]} -o $output -ggdb -static
+aarch64-linux-gnu-gcc ${files[@]} -o $output -ggdb -pthread -lm -static
 if [ $? -eq 0 ]; then
   chmod +x $output
 
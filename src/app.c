@@ -30,6 +30,9 @@
  *                            Functions
  *******************************************************************************/
 
+// commands run on several threads each print to their own output
+static _Thread_local FILE *a_stream;
+
 ae_t a_init(app_t *out, ap_t *params) {
   assert(out != NULL);
   assert(params != NULL);
@@ -52,6 +55,8 @@ ae_t a_init(app_t *out, ap_t *params) {
   }
 
   out->istream = stdin;
+  out->batch = 0;
+  out->result = 0;
   out->argalloc = 0;
   out->argbuf = NULL;
   memset(out->input, 0, sizeof(out->input));
@@ -81,7 +86,8 @@ void a_dispatch(app_t *a, cstr name, ac_t *cmds, size_t cmdnum, aa_t *args) {
     }
   }
 
-  printf("Error: '%s' unknown command\n", name);
+  a_printf("Error: '%s' unknown command\n", name);
+  a->result = ae_unknown;
 }
 
 ae_t a_prompt(app_t *a, aa_t *out) {
@@ -90,23 +96,50 @@ ae_t a_prompt(app_t *a, aa_t *out) {
   assert(a->istream != NULL);
   check_closed(a, {});
 
-  printf("%s > ", a->name);
-  fgets(a->input, sizeof(a->input) - 1, a->istream);
+  out->argv = a->argbuf;
+  out->argc = 0;
+  if (!a->batch)
+    a_printf("%s > ", a->name);
+
+  if (fgets(a->input, sizeof(a->input) - 1, a->istream) == NULL) {
+    if (!a->batch)
+      a_printf("\n");
+    a->closed = ae_closed;
+    return ae_ok;
+  }
+
+  return a_parse(a, a->input, out);
+}
+
+ae_t a_parse(app_t *a, cstr line, aa_t *out) {
+  assert(a != NULL);
+  assert(line != NULL);
+  assert(out != NULL);
+
+  if (line != a->input)
+    snprintf(a->input, sizeof(a->input), "%s", line);
+
   size_t newline = strcspn(a->input, "\n\r");
   a->input[newline] = '\0';
 
+  // a line starting with '#' is a comment, a '#' elsewhere is an argument
+  size_t blank = strspn(a->input, " \t");
+  if (a->input[blank] == '#')
+    a->input[0] = '\0';
+
   size_t num = 0;
-  str token = strtok(a->input, " ");
+  str save;
+  str token = strtok_r(a->input, " ", &save);
   while (token != NULL) {
     if (num >= a->argalloc) {
       a->argalloc++;
       a->argalloc *= 2;
-      a->argbuf = realloc(a->argbuf, a->argalloc);
+      a->argbuf = realloc(a->argbuf, sizeof(*a->argbuf) * a->argalloc);
       assert(a->argbuf != NULL);
     }
 
     a->argbuf[num] = token;
-    token = strtok(NULL, " ");
+    token = strtok_r(NULL, " ", &save);
     num++;
   }
 
@@ -115,11 +148,51 @@ ae_t a_prompt(app_t *a, aa_t *out) {
   return ae_ok;
 }
 
+ae_t a_pipe(app_t *a, aa_t *args) {
+  assert(a != NULL);
+  assert(args != NULL);
+
+  for (size_t first = 0, last = 0; first < args->argc; first = ++last) {
+    while (last < args->argc && strcmp(args->argv[last], "|") != 0)
+      last++;
+    if (last == first)
+      continue;
+
+    aa_t stage = {.argc = last - first, .argv = args->argv + first};
+    a_dispatch(a, stage.argv[0], a->cmdbuf, a->cmdnum, &stage);
+    if (a->result != 0)
+      return ae_err;
+  }
+
+  return ae_ok;
+}
+
+ae_t a_run(app_t *a) {
+  assert(a != NULL);
+  aa_t args;
+
+  while (a->closed != ae_closed) {
+    ae_t err = a_prompt(a, &args);
+    check_ae(err, {});
+    if (args.argc == 0)
+      continue;
+
+    if (a_pipe(a, &args) != ae_ok && a->batch)
+      return ae_err;
+  }
+
+  return ae_ok;
+}
+
 ae_t a_closed(app_t *a) {
   assert(a != NULL);
   return a->closed;
 }
 
+FILE *a_output(void) { return a_stream != NULL ? a_stream : stdout; }
+
+void a_redirect(FILE *out) { a_stream = out; }
+
 ae_t a_arg2long(cstr arg, long *out) {
   assert(arg != NULL);
   assert(out != NULL);
@@ -145,9 +218,9 @@ int a_help(struct app *a, aa_t *args) {
   assert(a != NULL);
   assert(args != NULL);
 
-  printf("%s\n", a->name);
+  a_printf("%s\n", a->name);
   for (size_t i = 0; i < a->cmdnum; i++) {
-    printf("%s: %s\n", a->cmdbuf[i].name, a->cmdbuf[i].description);
+    a_printf("%s: %s\n", a->cmdbuf[i].name, a->cmdbuf[i].description);
   }
 
   return ae_ok;
@@ -66,6 +66,12 @@ typedef struct {
 #define a_version(pmajor, pminor, prev)                                        \
   (av_t) { .major = pmajor, .minor = pminor, .revision = prev }
 
+/*
+ * Print to the output of the calling thread, see a_redirect
+ */
+#define a_printf(...) fprintf(a_output(), __VA_ARGS__)
+#define a_puts(s) fprintf(a_output(), "%s\n", s)
+
 /*
  * App parameter object
  */
@@ -96,6 +102,7 @@ typedef struct app {
   // input
   char input[1024];
   FILE *istream;
+  int batch;
 
   // state
   ae_t closed;
@@ -124,10 +131,29 @@ ae_t a_deinit(app_t *a);
 void a_dispatch(app_t *a, cstr name, ac_t *list, size_t num, aa_t *args);
 
 /*
- * Prompt user input
+ * Prompt user input. Without a prompt in batch mode; the end of the input
+ * closes the app.
  */
 ae_t a_prompt(app_t *a, aa_t *out);
 
+/*
+ * Split a command line into arguments, none if it is a '#' comment. The
+ * arguments live until the next line.
+ */
+ae_t a_parse(app_t *a, cstr line, aa_t *out);
+
+/*
+ * Dispatch the commands of a pipeline, separated by '|' arguments, in order.
+ * Stop at the first failing: ae_err, its result kept.
+ */
+ae_t a_pipe(app_t *a, aa_t *args);
+
+/*
+ * Prompt and dispatch commands until the app is closed. In batch mode, stop
+ * at the first command failing: ae_err, its result kept.
+ */
+ae_t a_run(app_t *a);
+
 /*
  * Check if app is closed
  */
@@ -138,6 +164,16 @@ ae_t a_closed(app_t *a);
  */
 ae_t a_arg2long(cstr arg, long *out);
 
+/*
+ * Output of the calling thread: stdout unless redirected
+ */
+FILE *a_output(void);
+
+/*
+ * Send the output of the calling thread to `out`, back to stdout if NULL
+ */
+void a_redirect(FILE *out);
+
 /*
  * Default 'help' command
  */
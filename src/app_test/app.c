@@ -82,6 +82,8 @@ app_t a_util_create_app(void) {
   app.version = a_version(1, 2, 3);
   app.name[0] = '\0';
   app.input[0] = '\0';
+  app.istream = NULL;
+  app.batch = 0;
   a_util_create_cmdbuf(&app);
   a_util_create_argbuf(&app, args);
   return app;
@@ -159,10 +161,9 @@ void a_test_dispatch(void) {
   aa_t args = {.argc = app.argalloc, .argv = app.argbuf};
 
   // act
-  ae_t error = a_dispatch(&app, "default", app.cmdbuf, app.cmdnum, &args);
+  a_dispatch(&app, "default", app.cmdbuf, app.cmdnum, &args);
 
   // assert
-  t_exp("%i", ae_ok, "%i", error, { a_util_close_app(&app); });
   t_exp("%i", 1, "%i", a_defcmd_calls, { a_util_close_app(&app); });
   t_exp("%i", 0, "%i", app.result, { a_util_close_app(&app); });
   t_ok();
@@ -195,10 +196,79 @@ void a_test_prompt(void) {
   a_util_close_app(&app);
 }
 
+void a_test_parse(void) {
+  // arrange
+  app_t app = a_util_create_app();
+  aa_t args, comment;
+
+  // act
+  ae_t error = a_parse(&app, "find #include 0\n", &args);
+  size_t argc = args.argc;
+  int hash = strcmp(args.argv[1], "#include");
+  a_parse(&app, "  # find 0", &comment);
+
+  // assert
+  t_exp("%i", ae_ok, "%i", error, { a_util_close_app(&app); });
+  t_exp("%zu", 3UL, "%zu", argc, { a_util_close_app(&app); });
+  t_exp("%i", 0, "%i", hash, { a_util_close_app(&app); });
+  t_exp("%zu", 0UL, "%zu", comment.argc, { a_util_close_app(&app); });
+  t_ok();
+
+  a_util_close_app(&app);
+}
+
+void a_test_pipe(void) {
+  // arrange
+  app_t app = a_util_create_app();
+  str line[] = {"|", "other", "arg1", "|", "default"};
+  aa_t args = {.argc = 5, .argv = line};
+  a_defcmd_calls = 0;
+  a_otrcmd_calls = 0;
+
+  // act
+  ae_t error = a_pipe(&app, &args);
+
+  // assert
+  t_exp("%i", ae_err, "%i", error, { a_util_close_app(&app); });
+  t_exp("%i", 6, "%i", app.result, { a_util_close_app(&app); });
+  t_exp("%i", 1, "%i", a_otrcmd_calls, { a_util_close_app(&app); });
+  t_exp("%i", 0, "%i", a_defcmd_calls, { a_util_close_app(&app); });
+  t_ok();
+
+  a_util_close_app(&app);
+}
+
+void a_test_run(void) {
+  // arrange
+  app_t app = a_util_create_app();
+  char script[] = "# comment\n\nother arg1\ndefault\n";
+  FILE *input = fmemopen(script, strlen(script), "r");
+  app.istream = input;
+  app.batch = 1;
+  a_otrcmd_calls = 0;
+
+  // act
+  ae_t error = a_run(&app);
+  app.istream = NULL;
+  fclose(input);
+
+  // assert
+  t_exp("%i", ae_err, "%i", error, { a_util_close_app(&app); });
+  t_exp("%i", 6, "%i", app.result, { a_util_close_app(&app); });
+  t_exp("%i", 1, "%i", a_otrcmd_calls, { a_util_close_app(&app); });
+  t_exp("%i", ae_opened, "%i", app.closed, { a_util_close_app(&app); });
+  t_ok();
+
+  a_util_close_app(&app);
+}
+
 int main(int argc, char **argv) {
   a_test_init();
   a_test_deinit();
   a_test_dispatch();
   a_test_prompt();
+  a_test_parse();
+  a_test_pipe();
+  a_test_run();
   return 0;
 }
@@ -5,7 +5,7 @@
 files=("app.c" "../app.c" "../stream.c")
 output="app.elf"
 
-gcc ${files[@]} -o $output -ggdb
+gcc ${files[@]} -o $output -ggdb -pthread
 if [ $? -eq 0 ]; then
   chmod +x $output
 
@@ -0,0 +1,632 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "chunk.h"
+
+/*******************************************************************************
+ *                       Internal utility functions
+ *******************************************************************************/
+
+/*
+ * Gear table: 256 fixed pseudo-random values (splitmix64 from 0), made by
+ * the first of the threads asking
+ */
+static const uint64_t *c_gear(void) {
+  static uint64_t table[256];
+  static int ready;
+  static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+  pthread_mutex_lock(&lock);
+  if (ready) {
+    pthread_mutex_unlock(&lock);
+    return table;
+  }
+
+  uint64_t x = 0;
+  for (int i = 0; i < 256; i++) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    table[i] = z ^ (z >> 31);
+  }
+
+  ready = 1;
+  pthread_mutex_unlock(&lock);
+  return table;
+}
+
+/*
+ * Highest `bits` bits set. With a left-shifting hash they depend on the
+ * last 64 bytes, where the lowest ones depend on the last few bytes only.
+ */
+static uint64_t c_mask(long bits) { return ~0ULL << (64 - bits); }
+
+/*
+ * Roll the hash over `n` bytes
+ */
+static void c_roll(uint64_t *hash, const uint8_t *p, long n) {
+  const uint64_t *gear = c_gear();
+  uint64_t h = *hash;
+  for (long i = 0; i < n; i++)
+    h = (h << 1) + gear[p[i]];
+  *hash = h;
+}
+
+/*
+ * Roll the hash over `n` bytes and stop after the first one leaving the
+ * masked bits clear. Returns the bytes consumed, or -1 if none matched.
+ */
+static long c_scan(uint64_t *hash, const uint8_t *p, long n, uint64_t mask) {
+  const uint64_t *gear = c_gear();
+  uint64_t h = *hash;
+  long i = 0;
+
+  // 2 bytes per iteration, one bound check
+  for (; i + 2 <= n; i += 2) {
+    h = (h << 1) + gear[p[i]];
+    if (!(h & mask)) {
+      *hash = h;
+      return i + 1;
+    }
+    h = (h << 1) + gear[p[i + 1]];
+    if (!(h & mask)) {
+      *hash = h;
+      return i + 2;
+    }
+  }
+
+  for (; i < n; i++) {
+    h = (h << 1) + gear[p[i]];
+    if (!(h & mask)) {
+      *hash = h;
+      return i + 1;
+    }
+  }
+
+  *hash = h;
+  return -1;
+}
+
+static void c_push(cl_t *list, ck_t chunk) {
+  if (list->num >= list->alloc) {
+    list->alloc = list->alloc > 0 ? list->alloc * 2 : 256;
+    list->chunks = realloc(list->chunks, sizeof(ck_t) * list->alloc);
+    assert(list->chunks != NULL);
+  }
+
+  list->chunks[list->num++] = chunk;
+}
+
+static uint64_t c_fingerprint(dc_t *c) {
+  dd_t d;
+  d_final(c, &d);
+
+  uint64_t value = 0;
+  for (long i = 0; i < d.size; i++)
+    value = (value << 8) | d.bytes[i];
+  return value;
+}
+
+static int c_cmpchunk(const void *a, const void *b) {
+  const ck_t *x = a;
+  const ck_t *y = b;
+  if (x->fingerprint != y->fingerprint)
+    return x->fingerprint < y->fingerprint ? -1 : 1;
+  return (x->size > y->size) - (x->size < y->size);
+}
+
+static int c_cmpgroup(const void *a, const void *b) {
+  const cg_t *x = a;
+  const cg_t *y = b;
+  long wx = x->size * (x->count - 1);
+  long wy = y->size * (y->count - 1);
+  if (wx != wy)
+    return wx > wy ? -1 : 1;
+  return (x->first > y->first) - (x->first < y->first);
+}
+
+static uint64_t c_xxh3(const uint8_t *p, long n) {
+  dc_t c;
+  d_init(&c, dk_xxh3);
+  d_update(&c, p, n);
+  return c_fingerprint(&c);
+}
+
+/*
+ * rsync weak checksum: sum of bytes and sum of running sums, 16 bits each
+ */
+typedef struct {
+  uint32_t a;
+  uint32_t b;
+} cw_t;
+
+static cw_t c_weak(const uint8_t *p, long n) {
+  cw_t w = {0, 0};
+  for (long i = 0; i < n; i++) {
+    w.a += p[i];
+    w.b += w.a;
+  }
+  return w;
+}
+
+static cw_t c_rollweak(cw_t w, uint8_t out, uint8_t in, long n) {
+  w.a += in - out;
+  w.b += w.a - (uint32_t)n * out;
+  return w;
+}
+
+static uint32_t c_weakkey(cw_t w) { return (w.a & 0xFFFF) | (w.b << 16); }
+
+/*
+ * First block of a signature whose checksums match the window, or -1
+ */
+static long c_match(cy_t *sig, cw_t w, const uint8_t *p) {
+  uint32_t key = c_weakkey(w);
+  long slot = (key * 0x9E3779B1U) & (sig->cap - 1);
+  uint64_t strong = 0;
+  int hashed = 0;
+
+  for (; sig->table[slot].count > 0; slot = (slot + 1) & (sig->cap - 1)) {
+    if (sig->table[slot].fingerprint != key)
+      continue;
+
+    // the strong hash is only computed once a weak checksum matched
+    if (!hashed) {
+      strong = c_xxh3(p, sig->blocksize);
+      hashed = 1;
+    }
+
+    uint32_t block = sig->table[slot].group;
+    if (sig->strong[block] == strong)
+      return block;
+  }
+
+  return -1;
+}
+
+static void c_span(cv_t *delta, long offset, long size, long source) {
+  if (size == 0)
+    return;
+
+  if (source < 0)
+    delta->inserted += size;
+  else
+    delta->copied += size;
+
+  // adjacent spans of the same kind, and contiguous copies, are merged
+  cp_t *last = delta->num > 0 ? &delta->spans[delta->num - 1] : NULL;
+  if (last != NULL && last->offset + last->size == offset &&
+      ((source < 0 && last->source < 0) ||
+       (source >= 0 && last->source >= 0 &&
+        last->source + last->size == source))) {
+    last->size += size;
+    return;
+  }
+
+  if (delta->num >= delta->alloc) {
+    delta->alloc = delta->alloc > 0 ? delta->alloc * 2 : 256;
+    delta->spans = realloc(delta->spans, sizeof(cp_t) * delta->alloc);
+    assert(delta->spans != NULL);
+  }
+
+  delta->spans[delta->num++] = (cp_t){offset, size, source};
+}
+
+/*******************************************************************************
+ *                            Chunk functions
+ *******************************************************************************/
+
+ce_t c_init(cc_t *out, long avg) {
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (avg < 256 || avg > (1L << 24) || (avg & (avg - 1)) != 0)
+    return ce_size;
+
+  long bits = __builtin_ctzl(avg);
+  out->min = avg / 4;
+  out->avg = avg;
+  out->max = avg * 8;
+  out->masks = c_mask(bits + 2);
+  out->maskl = c_mask(bits - 2);
+  return ce_ok;
+}
+
+long c_next(cc_t *c, const void *data, long size, int *cut) {
+  assert(c != NULL);
+  assert(data != NULL || size == 0);
+  assert(cut != NULL);
+
+  const uint8_t *p = data;
+  long i = 0;
+  *cut = 0;
+
+  // bytes before the last 64 of the minimum size can't affect the hash
+  if (c->len < c->min - 64) {
+    long skip = c->min - 64 - c->len;
+    skip = skip < size ? skip : size;
+    c->len += skip;
+    i += skip;
+  }
+
+  // then the hash warms up without cuts until the minimum size
+  if (i < size && c->len < c->min) {
+    long warm = c->min - c->len;
+    warm = warm < size - i ? warm : size - i;
+    c_roll(&c->hash, p + i, warm);
+    c->len += warm;
+    i += warm;
+  }
+
+  // harder mask until the average size, easier one until the maximum
+  while (i < size && c->len < c->max) {
+    uint64_t mask = c->len < c->avg ? c->masks : c->maskl;
+    long limit = c->len < c->avg ? c->avg : c->max;
+    long n = limit - c->len < size - i ? limit - c->len : size - i;
+    long found = c_scan(&c->hash, p + i, n, mask);
+
+    if (found > 0) {
+      c->len += found;
+      i += found;
+      *cut = 1;
+      break;
+    }
+
+    c->len += n;
+    i += n;
+  }
+
+  if (c->len >= c->max)
+    *cut = 1;
+
+  if (*cut) {
+    c->len = 0;
+    c->hash = 0;
+  }
+
+  return i;
+}
+
+ce_t c_stream(stream_t *s, cc_t *c, long off, long len, cl_t *out) {
+  assert(s != NULL);
+  assert(c != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return ce_range;
+
+  const long block = 1 << 20;
+  uint8_t *buf = malloc(block);
+  assert(buf != NULL);
+
+  dc_t fp;
+  d_init(&fp, dk_xxh3);
+  long start = off;
+
+  for (long done = 0; done < len;) {
+    long size = len - done < block ? len - done : block;
+    sb_t mem = {.data = buf, .size = size};
+    long read = 0;
+
+    if (s_readat(s, &mem, off + done, &read) != se_ok || read != size) {
+      free(buf);
+      return ce_read;
+    }
+
+    // boundaries and fingerprints come from the same pass over the block
+    for (long i = 0; i < size;) {
+      int cut;
+      long n = c_next(c, buf + i, size - i, &cut);
+      d_update(&fp, buf + i, n);
+      i += n;
+
+      if (cut) {
+        long end = off + done + i;
+        c_push(out, (ck_t){start, end - start, c_fingerprint(&fp)});
+        d_init(&fp, dk_xxh3);
+        start = end;
+      }
+    }
+
+    done += size;
+  }
+
+  if (start < off + len) {
+    c_push(out, (ck_t){start, off + len - start, c_fingerprint(&fp)});
+  }
+
+  c->len = 0;
+  c->hash = 0;
+  free(buf);
+  return ce_ok;
+}
+
+ce_t c_fixed(stream_t *s, long off, long len, long size, cl_t *out) {
+  assert(s != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  // a block is read whole
+  if (size <= 0 || size > (1L << 24))
+    return ce_size;
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return ce_range;
+
+  // whole blocks per read, about 1 MiB
+  long batch = (1L << 20) / size;
+  batch = (batch > 0 ? batch : 1) * size;
+  uint8_t *buf = malloc(batch);
+  assert(buf != NULL);
+
+  for (long done = 0; done < len;) {
+    long n = len - done < batch ? len - done : batch;
+    sb_t mem = {.data = buf, .size = n};
+    long read = 0;
+
+    if (s_readat(s, &mem, off + done, &read) != se_ok || read != n) {
+      free(buf);
+      return ce_read;
+    }
+
+    for (long i = 0; i < n; i += size) {
+      long m = n - i < size ? n - i : size;
+      dc_t fp;
+      d_init(&fp, dk_xxh3);
+      d_update(&fp, buf + i, m);
+      c_push(out, (ck_t){off + done + i, m, c_fingerprint(&fp)});
+    }
+
+    done += n;
+  }
+
+  free(buf);
+  return ce_ok;
+}
+
+ce_t c_dupes(cl_t *list, cd_t *out) {
+  assert(list != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (list->num >= UINT32_MAX)
+    return ce_size;
+
+  // open addressing, at most half full
+  long cap = 16;
+  while (cap < 2 * list->num)
+    cap *= 2;
+
+  ct_t *table = calloc(cap, sizeof(ct_t));
+  cg_t *groups = malloc(sizeof(cg_t) * (list->num + 1));
+  out->next = malloc(sizeof(uint32_t) * (list->num + 1));
+  assert(table != NULL && groups != NULL && out->next != NULL);
+
+  // chunks are prepended to their group, backwards to keep offsets sorted
+  long num = 0;
+  for (long i = list->num - 1; i >= 0; i--) {
+    ck_t *chunk = &list->chunks[i];
+    long slot = chunk->fingerprint & (cap - 1);
+
+    while (table[slot].count > 0 &&
+           (table[slot].fingerprint != chunk->fingerprint ||
+            groups[table[slot].group].size != chunk->size))
+      slot = (slot + 1) & (cap - 1);
+
+    if (table[slot].count == 0) {
+      table[slot] = (ct_t){chunk->fingerprint, num, 0};
+      groups[num++] = (cg_t){i, 0, chunk->size};
+      out->next[i] = UINT32_MAX;
+    } else {
+      out->next[i] = groups[table[slot].group].first;
+      groups[table[slot].group].first = i;
+    }
+
+    table[slot].count++;
+    groups[table[slot].group].count++;
+  }
+
+  free(table);
+
+  // only groups of 2 chunks or more are kept
+  out->num = 0;
+  for (long g = 0; g < num; g++) {
+    if (groups[g].count > 1) {
+      out->wasted += groups[g].size * (groups[g].count - 1);
+      groups[out->num++] = groups[g];
+    }
+  }
+
+  qsort(groups, out->num, sizeof(cg_t), c_cmpgroup);
+  out->groups = groups;
+  return ce_ok;
+}
+
+ce_t c_sign(stream_t *s, long blocksize, cy_t *out) {
+  assert(s != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (blocksize <= 0 || blocksize > (1L << 24))
+    return ce_size;
+
+  if (s->size / blocksize >= UINT32_MAX)
+    return ce_size;
+
+  out->blocksize = blocksize;
+  out->blocks = s->size / blocksize;
+  out->cap = 16;
+  while (out->cap < 2 * out->blocks)
+    out->cap *= 2;
+
+  out->strong = malloc(sizeof(uint64_t) * (out->blocks + 1));
+  out->table = calloc(out->cap, sizeof(ct_t));
+  assert(out->strong != NULL && out->table != NULL);
+
+  long batch = (1L << 20) / blocksize;
+  batch = (batch > 0 ? batch : 1) * blocksize;
+  uint8_t *buf = malloc(batch);
+  assert(buf != NULL);
+
+  for (long block = 0; block < out->blocks;) {
+    long n = (out->blocks - block) * blocksize;
+    n = n < batch ? n : batch;
+    sb_t mem = {.data = buf, .size = n};
+    long read = 0;
+
+    if (s_readat(s, &mem, block * blocksize, &read) != se_ok || read != n) {
+      free(buf);
+      return ce_read;
+    }
+
+    for (long i = 0; i < n; i += blocksize, block++) {
+      uint32_t key = c_weakkey(c_weak(buf + i, blocksize));
+      long slot = (key * 0x9E3779B1U) & (out->cap - 1);
+      while (out->table[slot].count > 0)
+        slot = (slot + 1) & (out->cap - 1);
+
+      out->table[slot] = (ct_t){key, block, 1};
+      out->strong[block] = c_xxh3(buf + i, blocksize);
+    }
+  }
+
+  free(buf);
+  return ce_ok;
+}
+
+ce_t c_delta(stream_t *s, long off, long len, cy_t *sig, cv_t *out) {
+  assert(s != NULL);
+  assert(sig != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return ce_range;
+
+  // the window may straddle two reads: the tail is moved to the front
+  const long bs = sig->blocksize;
+  const long chunk = 1L << 20;
+  uint8_t *buf = malloc(chunk + bs);
+  assert(buf != NULL);
+
+  long base = off;     // stream offset of buf[0]
+  long filled = 0;     // bytes in buf
+  long i = 0;          // window start in buf
+  long pending = off;  // start of bytes not yet in a span
+  cw_t w = {0, 0};
+  int rolling = 0;
+
+  while (base + i + bs <= off + len && sig->blocks > 0) {
+    if (i + bs > filled) {
+      memmove(buf, buf + i, filled - i);
+      base += i;
+      filled -= i;
+      i = 0;
+
+      long n = off + len - (base + filled);
+      n = n < chunk ? n : chunk;
+      sb_t mem = {.data = buf + filled, .size = n};
+      long read = 0;
+
+      if (s_readat(s, &mem, base + filled, &read) != se_ok || read != n) {
+        free(buf);
+        return ce_read;
+      }
+
+      filled += n;
+    }
+
+    if (!rolling) {
+      w = c_weak(buf + i, bs);
+      rolling = 1;
+    }
+
+    long block = c_match(sig, w, buf + i);
+    if (block >= 0) {
+      c_span(out, pending, base + i - pending, -1);
+      c_span(out, base + i, bs, block * bs);
+      i += bs;
+      pending = base + i;
+      rolling = 0;
+      continue;
+    }
+
+    if (base + i + bs < off + len && i + bs < filled)
+      w = c_rollweak(w, buf[i], buf[i + bs], bs);
+    else
+      rolling = 0;
+    i++;
+  }
+
+  c_span(out, pending, off + len - pending, -1);
+  free(buf);
+  return ce_ok;
+}
+
+void c_stats(cl_t *list, cs_t *out) {
+  assert(list != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  out->num = list->num;
+  if (list->num == 0)
+    return;
+
+  out->min = list->chunks[0].size;
+  double sum = 0, squares = 0;
+
+  for (long i = 0; i < list->num; i++) {
+    long size = list->chunks[i].size;
+    out->min = size < out->min ? size : out->min;
+    out->max = size > out->max ? size : out->max;
+    out->buckets[63 - __builtin_clzl(size)]++;
+    out->total += size;
+    sum += size;
+    squares += (double)size * size;
+  }
+
+  out->mean = sum / list->num;
+  out->stddev = sqrt(fmax(squares / list->num - out->mean * out->mean, 0));
+
+  // identical chunks are adjacent once sorted by fingerprint
+  ck_t *sorted = malloc(sizeof(ck_t) * list->num);
+  assert(sorted != NULL);
+  memcpy(sorted, list->chunks, sizeof(ck_t) * list->num);
+  qsort(sorted, list->num, sizeof(ck_t), c_cmpchunk);
+
+  for (long i = 0; i < list->num; i++) {
+    if (i == 0 || c_cmpchunk(&sorted[i - 1], &sorted[i]) != 0) {
+      out->distinct++;
+      out->unique += sorted[i].size;
+    }
+  }
+
+  free(sorted);
+}
+
+void c_free(cl_t *list) {
+  assert(list != NULL);
+  free(list->chunks);
+  memset(list, 0, sizeof(*list));
+}
+
+void c_freedupes(cd_t *dupes) {
+  assert(dupes != NULL);
+  free(dupes->groups);
+  free(dupes->next);
+  memset(dupes, 0, sizeof(*dupes));
+}
+
+void c_freesign(cy_t *sig) {
+  assert(sig != NULL);
+  free(sig->strong);
+  free(sig->table);
+  memset(sig, 0, sizeof(*sig));
+}
+
+void c_freedelta(cv_t *delta) {
+  assert(delta != NULL);
+  free(delta->spans);
+  memset(delta, 0, sizeof(*delta));
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "digest.h"
+#include "stream.h"
+#include "typedef.h"
+
+/*******************************************************************************
+ *                          Chunk object definitions
+ *******************************************************************************/
+
+/*
+ * Chunk error codes
+ */
+typedef enum { ce_ok, ce_size, ce_read, ce_range } ce_t;
+
+/*
+ * Content-defined chunker (FastCDC with normalized chunking)
+ */
+typedef struct {
+  uint64_t hash;
+  long len;
+  long min;
+  long avg;
+  long max;
+  uint64_t masks;
+  uint64_t maskl;
+} cc_t;
+
+/*
+ * Chunk with its xxh3 fingerprint
+ */
+typedef struct {
+  long offset;
+  long size;
+  uint64_t fingerprint;
+} ck_t;
+
+/*
+ * List of chunks
+ */
+typedef struct {
+  ck_t *chunks;
+  long num;
+  long alloc;
+} cl_t;
+
+/*
+ * Chunk size statistics. Bucket `i` counts sizes in [2^i, 2^(i+1)).
+ */
+typedef struct {
+  long num;
+  long min;
+  long max;
+  double mean;
+  double stddev;
+  long buckets[64];
+  long distinct;
+  long unique;
+  long total;
+} cs_t;
+
+/*
+ * Group of identical chunks, linked through `next` from `first`
+ */
+typedef struct {
+  uint32_t first;
+  uint32_t count;
+  long size;
+} cg_t;
+
+/*
+ * Hash table slot, empty when `count` is zero
+ */
+typedef struct {
+  uint64_t fingerprint;
+  uint32_t group;
+  uint32_t count;
+} ct_t;
+
+/*
+ * Duplicate chunks of a list, groups sorted by wasted bytes
+ */
+typedef struct {
+  cg_t *groups;
+  long num;
+  uint32_t *next;
+  long wasted;
+} cd_t;
+
+/*
+ * Block signature of a file: rolling checksums in a hash table (the
+ * checksum as fingerprint, the block as group) and xxh3 of every block
+ */
+typedef struct {
+  long blocksize;
+  long blocks;
+  uint64_t *strong;
+  ct_t *table;
+  long cap;
+} cy_t;
+
+/*
+ * Delta span: `size` bytes at `offset` copied from `source` in the other
+ * file, or inserted when `source` is -1
+ */
+typedef struct {
+  long offset;
+  long size;
+  long source;
+} cp_t;
+
+/*
+ * List of delta spans
+ */
+typedef struct {
+  cp_t *spans;
+  long num;
+  long alloc;
+  long copied;
+  long inserted;
+} cv_t;
+
+/*******************************************************************************
+ *                            Chunk functions
+ *******************************************************************************/
+
+/*
+ * Init a chunker for an average size, a power of 2 from 256 to 16 MiB.
+ * Chunks are at least a quarter and at most 8 times that size.
+ */
+ce_t c_init(cc_t *out, long avg);
+
+/*
+ * Feed up to `size` bytes and get how many were consumed. `cut` is set when
+ * a chunk ends at the last consumed byte.
+ */
+long c_next(cc_t *c, const void *data, long size, int *cut);
+
+/*
+ * Chunk and fingerprint `len` bytes of a stream from `off` in one pass
+ */
+ce_t c_stream(stream_t *s, cc_t *c, long off, long len, cl_t *out);
+
+/*
+ * Fingerprint fixed-size blocks of `len` bytes of a stream from `off`, of
+ * 1 byte to 16 MiB
+ */
+ce_t c_fixed(stream_t *s, long off, long len, long size, cl_t *out);
+
+/*
+ * Find groups of identical chunks with a hash table of fingerprints. Memory
+ * is linear in the number of chunks.
+ */
+ce_t c_dupes(cl_t *list, cd_t *out);
+
+/*
+ * Sign every whole block of a stream
+ */
+ce_t c_sign(stream_t *s, long blocksize, cy_t *out);
+
+/*
+ * Express `len` bytes of a stream from `off` as blocks copied from a signed
+ * file, found at any offset, and inserted bytes. The stream is read once.
+ */
+ce_t c_delta(stream_t *s, long off, long len, cy_t *sig, cv_t *out);
+
+/*
+ * Compute size statistics and the distinct chunks of a list
+ */
+void c_stats(cl_t *list, cs_t *out);
+
+/*
+ * Free a list of chunks
+ */
+void c_free(cl_t *list);
+
+/*
+ * Free duplicate groups
+ */
+void c_freedupes(cd_t *dupes);
+
+/*
+ * Free a block signature
+ */
+void c_freesign(cy_t *sig);
+
+/*
+ * Free a list of delta spans
+ */
+void c_freedelta(cv_t *delta);
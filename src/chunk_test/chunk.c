@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "../chunk.h"
+#include "../test.h"
+
+/*******************************************************************************
+ *                            Test data
+ *******************************************************************************/
+
+cstr c_path = "chunk.bin";
+
+/*******************************************************************************
+ *                       Test utility functions
+ *******************************************************************************/
+
+uint8_t *c_util_data(long len, uint64_t seed) {
+  uint8_t *data = malloc(len);
+  for (long i = 0; i < len; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    data[i] = seed >> 56;
+  }
+  return data;
+}
+
+long c_util_cuts(cc_t *c, uint8_t *data, long len, long step, long *cuts) {
+  long num = 0;
+  for (long i = 0; i < len;) {
+    int cut;
+    long n = step < len - i ? step : len - i;
+    i += c_next(c, data + i, n, &cut);
+    if (cut) {
+      cuts[num++] = i;
+    }
+  }
+  return num;
+}
+
+cl_t c_util_stream(uint8_t *data, long len) {
+  FILE *file = fopen(c_path, "w");
+  fwrite(data, 1, len, file);
+  fclose(file);
+
+  stream_t stream;
+  cc_t chunker;
+  cl_t list;
+  s_openfile(&stream, c_path, sm_read);
+  c_init(&chunker, 1024);
+  c_stream(&stream, &chunker, 0, len, &list);
+  s_close(&stream);
+  remove(c_path);
+  return list;
+}
+
+/*******************************************************************************
+ *                           Test cases
+ *******************************************************************************/
+
+void c_test_init(void) {
+  // arrange
+  cc_t chunker;
+
+  // act
+  ce_t small = c_init(&chunker, 128);
+  ce_t odd = c_init(&chunker, 3000);
+  ce_t error = c_init(&chunker, 4096);
+
+  // assert
+  t_exp("%i", ce_size, "%i", small, {});
+  t_exp("%i", ce_size, "%i", odd, {});
+  t_exp("%i", ce_ok, "%i", error, {});
+  t_exp("%li", 1024L, "%li", chunker.min, {});
+  t_exp("%li", 32768L, "%li", chunker.max, {});
+  t_ok();
+}
+
+void c_test_next(void) {
+  // arrange
+  long len = 1 << 18;
+  uint8_t *data = c_util_data(len, 1);
+  long whole[1024], pieces[1024];
+  cc_t chunker;
+
+  // act
+  c_init(&chunker, 1024);
+  long n = c_util_cuts(&chunker, data, len, len, whole);
+  c_init(&chunker, 1024);
+  long m = c_util_cuts(&chunker, data, len, 77, pieces);
+
+  // assert
+  free(data);
+  t_exp("%li", n, "%li", m, {});
+  for (long i = 0; i < n; i++) {
+    long size = whole[i] - (i > 0 ? whole[i - 1] : 0);
+    t_exp("%li", whole[i], "%li", pieces[i], {});
+    t_exp("%i", 1, "%i", (size >= 256 && size <= 8192), {});
+  }
+  t_ok();
+}
+
+void c_test_stream_shifted(void) {
+  // arrange
+  long len = 1 << 18;
+  uint8_t *data = c_util_data(len + 100, 2);
+
+  // act
+  cl_t base = c_util_stream(data + 100, len);
+  cl_t shifted = c_util_stream(data, len + 100);
+
+  // assert
+  long same = 0;
+  for (long i = 0; i < base.num; i++) {
+    for (long j = 0; j < shifted.num; j++) {
+      same += base.chunks[i].fingerprint == shifted.chunks[j].fingerprint;
+    }
+  }
+
+  long num = base.num;
+  long last = base.chunks[num - 1].offset + base.chunks[num - 1].size;
+  c_free(&base);
+  c_free(&shifted);
+  free(data);
+  t_exp("%li", len, "%li", last, {});
+  t_exp("%i", 1, "%i", (same >= num - 2), {});
+  t_ok();
+}
+
+void c_test_stats(void) {
+  // arrange
+  ck_t chunks[] = {{0, 4, 7}, {4, 16, 9}, {20, 4, 7}, {24, 5, 7}};
+  cl_t list = {.chunks = chunks, .num = 4, .alloc = 4};
+  cs_t stats;
+
+  // act
+  c_stats(&list, &stats);
+
+  // assert
+  t_exp("%li", 4L, "%li", stats.min, {});
+  t_exp("%li", 16L, "%li", stats.max, {});
+  t_exp("%li", 3L, "%li", stats.buckets[2], {});
+  t_exp("%li", 1L, "%li", stats.buckets[4], {});
+  t_exp("%li", 3L, "%li", stats.distinct, {});
+  t_exp("%li", 25L, "%li", stats.unique, {});
+  t_exp("%li", 29L, "%li", stats.total, {});
+  t_ok();
+}
+
+void c_test_fixed(void) {
+  // arrange
+  uint8_t data[100] = {0};
+  memcpy(data + 32, "copy", 4);
+  FILE *file = fopen(c_path, "w");
+  fwrite(data, 1, sizeof(data), file);
+  fclose(file);
+
+  stream_t stream;
+  cl_t list;
+  s_openfile(&stream, c_path, sm_read);
+
+  // act
+  ce_t size = c_fixed(&stream, 0, 100, 0, &list);
+  ce_t huge = c_fixed(&stream, 0, 100, 1L << 40, &list);
+  ce_t error = c_fixed(&stream, 0, 100, 16, &list);
+
+  // assert
+  s_close(&stream);
+  remove(c_path);
+  t_exp("%i", ce_size, "%i", size, { c_free(&list); });
+  t_exp("%i", ce_size, "%i", huge, { c_free(&list); });
+  t_exp("%i", ce_ok, "%i", error, { c_free(&list); });
+  t_exp("%li", 7L, "%li", list.num, { c_free(&list); });
+  t_exp("%li", 4L, "%li", list.chunks[6].size, { c_free(&list); });
+  t_exp("%lu", list.chunks[0].fingerprint, "%lu", list.chunks[1].fingerprint,
+        { c_free(&list); });
+  t_nexp("%lu", list.chunks[0].fingerprint, "%lu", list.chunks[2].fingerprint,
+         { c_free(&list); });
+  c_free(&list);
+  t_ok();
+}
+
+void c_test_dupes(void) {
+  // arrange
+  ck_t chunks[] = {{0, 4, 7}, {4, 16, 9}, {20, 4, 7}, {24, 8, 9},
+                   {32, 16, 9}, {48, 4, 7}, {52, 4, 5}, {56, 16, 9}};
+  cl_t list = {.chunks = chunks, .num = 8, .alloc = 8};
+  cd_t dupes;
+
+  // act
+  ce_t error = c_dupes(&list, &dupes);
+
+  // assert
+  uint32_t second = dupes.next[dupes.groups[0].first];
+  uint32_t third = dupes.next[second];
+  cg_t group1 = dupes.groups[1];
+  long wasted = dupes.wasted;
+  long num = dupes.num;
+  c_freedupes(&dupes);
+  t_exp("%i", ce_ok, "%i", error, {});
+  t_exp("%li", 2L, "%li", num, {});
+  t_exp("%li", 40L, "%li", wasted, {});
+  t_exp("%u", 4U, "%u", second, {});
+  t_exp("%u", 7U, "%u", third, {});
+  t_exp("%u", 0U, "%u", group1.first, {});
+  t_exp("%u", 3U, "%u", group1.count, {});
+  t_ok();
+}
+
+void c_test_delta(void) {
+  // arrange
+  long len = 1 << 16;
+  uint8_t *data = c_util_data(len, 3);
+  FILE *file = fopen(c_path, "w");
+  fwrite(data, 1, len, file);
+  fclose(file);
+
+  // the other file shifted by 100 inserted bytes
+  cstr newpath = "chunk-new.bin";
+  file = fopen(newpath, "w");
+  fwrite(data + len - 100, 1, 100, file);
+  fwrite(data, 1, len, file);
+  fclose(file);
+  free(data);
+
+  stream_t other, stream;
+  cy_t sig;
+  cv_t delta;
+  s_openfile(&other, c_path, sm_read);
+  s_openfile(&stream, newpath, sm_read);
+
+  // act
+  ce_t sign = c_sign(&other, 1024, &sig);
+  ce_t error = c_delta(&stream, 0, len + 100, &sig, &delta);
+
+  // assert
+  s_close(&other);
+  s_close(&stream);
+  remove(c_path);
+  remove(newpath);
+  c_freesign(&sig);
+  t_exp("%i", ce_ok, "%i", sign, { c_freedelta(&delta); });
+  t_exp("%i", ce_ok, "%i", error, { c_freedelta(&delta); });
+  t_exp("%li", 2L, "%li", delta.num, { c_freedelta(&delta); });
+  t_exp("%li", 100L, "%li", delta.inserted, { c_freedelta(&delta); });
+  t_exp("%li", len, "%li", delta.copied, { c_freedelta(&delta); });
+  t_exp("%li", 0L, "%li", delta.spans[1].source, { c_freedelta(&delta); });
+  t_exp("%li", 100L, "%li", delta.spans[1].offset, { c_freedelta(&delta); });
+  c_freedelta(&delta);
+  t_ok();
+}
+
+int main(int argc, char **argv) {
+  c_test_init();
+  c_test_next();
+  c_test_stream_shifted();
+  c_test_stats();
+  c_test_fixed();
+  c_test_dupes();
+  c_test_delta();
+  return 0;
+}
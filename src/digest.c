@@ -0,0 +1,1025 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "digest.h"
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#endif
+
+#define check_de(de, clean)                                                    \
+  if (de != de_ok) {                                                           \
+    clean;                                                                     \
+    return de;                                                                 \
+  }
+
+/*******************************************************************************
+ *                            Constants
+ *******************************************************************************/
+
+static const uint32_t d_sha256k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t d_sha256h[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const uint8_t d_xxhsecret[192] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+#define D_PRIME32_1 0x9E3779B1U
+#define D_PRIME32_2 0x85EBCA77U
+#define D_PRIME32_3 0xC2B2AE3DU
+#define D_PRIME64_1 0x9E3779B185EBCA87ULL
+#define D_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define D_PRIME64_3 0x165667B19E3779F9ULL
+#define D_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define D_PRIME64_5 0x27D4EB2F165667C5ULL
+#define D_PRIME_MX1 0x165667919E3779F9ULL
+#define D_PRIME_MX2 0x9FB21C651E98DF25ULL
+
+/*******************************************************************************
+ *                       Internal utility functions
+ *******************************************************************************/
+
+static uint32_t d_read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint64_t d_read64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint64_t d_rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static uint32_t d_rotr32(uint32_t x, int r) { return (x >> r) | (x << (32 - r)); }
+
+static void d_bigendian(dd_t *out, uint64_t value, long size) {
+  out->size = size;
+  for (long i = 0; i < size; i++)
+    out->bytes[i] = value >> (8 * (size - 1 - i));
+}
+
+/*
+ * CPU features, probed once by the first of the threads asking
+ */
+typedef struct {
+  int probed;
+  int crc;
+  int sha;
+} df_t;
+
+static df_t d_features(void) {
+  static df_t features;
+  static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+  pthread_mutex_lock(&lock);
+  if (features.probed) {
+    pthread_mutex_unlock(&lock);
+    return features;
+  }
+
+#if defined(__x86_64__)
+  unsigned a, b, c, d;
+  if (__get_cpuid(1, &a, &b, &c, &d)) {
+    features.crc = (c >> 20) & 1;
+    int ssse3 = (c >> 9) & 1;
+    int sse41 = (c >> 19) & 1;
+    if (__get_cpuid_count(7, 0, &a, &b, &c, &d))
+      features.sha = ((b >> 29) & 1) && ssse3 && sse41;
+  }
+#elif defined(__aarch64__)
+  unsigned long hwcap = getauxval(AT_HWCAP);
+  features.crc = (hwcap & HWCAP_CRC32) != 0;
+  features.sha = (hwcap & HWCAP_SHA2) != 0;
+#endif
+
+  features.probed = 1;
+  pthread_mutex_unlock(&lock);
+  return features;
+}
+
+/*******************************************************************************
+ *                                CRC32C
+ *******************************************************************************/
+
+static uint32_t d_crc32c_sw(uint32_t crc, const uint8_t *p, long n) {
+  static uint32_t table[256];
+  static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+  pthread_mutex_lock(&lock);
+  if (table[1] == 0) {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++)
+        c = (c >> 1) ^ (0x82F63B78U & -(c & 1));
+      table[i] = c;
+    }
+  }
+  pthread_mutex_unlock(&lock);
+
+  for (long i = 0; i < n; i++)
+    crc = (crc >> 8) ^ table[(crc ^ p[i]) & 0xFF];
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) static uint32_t
+d_crc32c_hw(uint32_t crc, const uint8_t *p, long n) {
+  uint64_t c = crc;
+  for (; n >= 8; n -= 8, p += 8)
+    c = _mm_crc32_u64(c, d_read64(p));
+
+  crc = c;
+  for (; n > 0; n--, p++)
+    crc = _mm_crc32_u8(crc, *p);
+  return crc;
+}
+#elif defined(__aarch64__)
+__attribute__((target("+crc"))) static uint32_t
+d_crc32c_hw(uint32_t crc, const uint8_t *p, long n) {
+  for (; n >= 8; n -= 8, p += 8)
+    crc = __crc32cd(crc, d_read64(p));
+
+  for (; n > 0; n--, p++)
+    crc = __crc32cb(crc, *p);
+  return crc;
+}
+#else
+static uint32_t d_crc32c_hw(uint32_t crc, const uint8_t *p, long n) {
+  return d_crc32c_sw(crc, p, n);
+}
+#endif
+
+static uint32_t d_crc32c(uint32_t crc, const uint8_t *p, long n) {
+  if (d_features().crc)
+    return d_crc32c_hw(crc, p, n);
+  return d_crc32c_sw(crc, p, n);
+}
+
+/*******************************************************************************
+ *                                SHA-256
+ *******************************************************************************/
+
+static void d_sha256_sw(uint32_t state[8], const uint8_t *p, long blocks) {
+  for (; blocks > 0; blocks--, p += 64) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++)
+      w[i] = __builtin_bswap32(d_read32(p + 4 * i));
+
+    for (int i = 16; i < 64; i++) {
+      uint32_t s0 = d_rotr32(w[i - 15], 7) ^ d_rotr32(w[i - 15], 18) ^
+                    (w[i - 15] >> 3);
+      uint32_t s1 = d_rotr32(w[i - 2], 17) ^ d_rotr32(w[i - 2], 19) ^
+                    (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t v[8];
+    memcpy(v, state, sizeof(v));
+    for (int i = 0; i < 64; i++) {
+      uint32_t s1 = d_rotr32(v[4], 6) ^ d_rotr32(v[4], 11) ^ d_rotr32(v[4], 25);
+      uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+      uint32_t t1 = v[7] + s1 + ch + d_sha256k[i] + w[i];
+      uint32_t s0 = d_rotr32(v[0], 2) ^ d_rotr32(v[0], 13) ^ d_rotr32(v[0], 22);
+      uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+      memmove(v + 1, v, sizeof(uint32_t) * 7);
+      v[4] += t1;
+      v[0] = t1 + s0 + maj;
+    }
+
+    for (int i = 0; i < 8; i++)
+      state[i] += v[i];
+  }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sha,sse4.1,ssse3"))) static void
+d_sha256_hw(uint32_t state[8], const uint8_t *p, long blocks) {
+  const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                                      0x0405060700010203ULL);
+
+  // state words are kept as ABEF and CDGH
+  __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((void *)&state[0]), 0xB1);
+  __m128i s1 = _mm_shuffle_epi32(_mm_loadu_si128((void *)&state[4]), 0x1B);
+  __m128i s0 = _mm_alignr_epi8(tmp, s1, 8);
+  s1 = _mm_blend_epi16(s1, tmp, 0xF0);
+
+  for (; blocks > 0; blocks--, p += 64) {
+    __m128i abef = s0;
+    __m128i cdgh = s1;
+    __m128i w[4];
+
+    for (int i = 0; i < 16; i++) {
+      __m128i *wi = &w[i & 3];
+      if (i < 4) {
+        *wi = _mm_shuffle_epi8(_mm_loadu_si128((void *)(p + 16 * i)), mask);
+      } else {
+        __m128i w1 = w[(i - 1) & 3];
+        __m128i w2 = w[(i - 2) & 3];
+        __m128i x = _mm_sha256msg1_epu32(*wi, w[(i - 3) & 3]);
+        x = _mm_add_epi32(x, _mm_alignr_epi8(w1, w2, 4));
+        *wi = _mm_sha256msg2_epu32(x, w1);
+      }
+
+      __m128i k = _mm_loadu_si128((void *)&d_sha256k[4 * i]);
+      __m128i msg = _mm_add_epi32(*wi, k);
+      s1 = _mm_sha256rnds2_epu32(s1, s0, msg);
+      s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(msg, 0x0E));
+    }
+
+    s0 = _mm_add_epi32(s0, abef);
+    s1 = _mm_add_epi32(s1, cdgh);
+  }
+
+  tmp = _mm_shuffle_epi32(s0, 0x1B);
+  s1 = _mm_shuffle_epi32(s1, 0xB1);
+  s0 = _mm_blend_epi16(tmp, s1, 0xF0);
+  s1 = _mm_alignr_epi8(s1, tmp, 8);
+  _mm_storeu_si128((void *)&state[0], s0);
+  _mm_storeu_si128((void *)&state[4], s1);
+}
+#elif defined(__aarch64__)
+__attribute__((target("+crypto"))) static void
+d_sha256_hw(uint32_t state[8], const uint8_t *p, long blocks) {
+  uint32x4_t s0 = vld1q_u32(&state[0]);
+  uint32x4_t s1 = vld1q_u32(&state[4]);
+
+  for (; blocks > 0; blocks--, p += 64) {
+    uint32x4_t abcd = s0;
+    uint32x4_t efgh = s1;
+    uint32x4_t w[4];
+
+    for (int i = 0; i < 16; i++) {
+      uint32x4_t *wi = &w[i & 3];
+      if (i < 4) {
+        uint8x16_t bytes = vrev32q_u8(vld1q_u8(p + 16 * i));
+        *wi = vreinterpretq_u32_u8(bytes);
+      } else {
+        uint32x4_t x = vsha256su0q_u32(*wi, w[(i - 3) & 3]);
+        *wi = vsha256su1q_u32(x, w[(i - 2) & 3], w[(i - 1) & 3]);
+      }
+
+      uint32x4_t msg = vaddq_u32(*wi, vld1q_u32(&d_sha256k[4 * i]));
+      uint32x4_t prev = s0;
+      s0 = vsha256hq_u32(s0, s1, msg);
+      s1 = vsha256h2q_u32(s1, prev, msg);
+    }
+
+    s0 = vaddq_u32(s0, abcd);
+    s1 = vaddq_u32(s1, efgh);
+  }
+
+  vst1q_u32(&state[0], s0);
+  vst1q_u32(&state[4], s1);
+}
+#else
+static void d_sha256_hw(uint32_t state[8], const uint8_t *p, long blocks) {
+  d_sha256_sw(state, p, blocks);
+}
+#endif
+
+static void d_sha256_blocks(uint32_t state[8], const uint8_t *p, long blocks) {
+  if (d_features().sha)
+    d_sha256_hw(state, p, blocks);
+  else
+    d_sha256_sw(state, p, blocks);
+}
+
+static void d_sha256_update(dsha_t *c, const uint8_t *p, long n) {
+  c->length += n;
+
+  if (c->buffered > 0) {
+    long fill = 64 - c->buffered < n ? 64 - c->buffered : n;
+    memcpy(c->buffer + c->buffered, p, fill);
+    c->buffered += fill;
+    p += fill;
+    n -= fill;
+
+    if (c->buffered < 64)
+      return;
+
+    d_sha256_blocks(c->state, c->buffer, 1);
+    c->buffered = 0;
+  }
+
+  d_sha256_blocks(c->state, p, n / 64);
+  memcpy(c->buffer, p + (n & ~63L), n & 63);
+  c->buffered = n & 63;
+}
+
+static void d_sha256_final(dsha_t *c, dd_t *out) {
+  uint64_t bits = c->length * 8;
+  uint8_t pad[72] = {0x80};
+  long padlen = (c->buffered < 56 ? 56 : 120) - c->buffered;
+
+  for (int i = 0; i < 8; i++)
+    pad[padlen + i] = bits >> (56 - 8 * i);
+
+  d_sha256_update(c, pad, padlen + 8);
+  out->size = 32;
+  for (int i = 0; i < 8; i++) {
+    uint32_t word = __builtin_bswap32(c->state[i]);
+    memcpy(out->bytes + 4 * i, &word, sizeof(word));
+  }
+}
+
+/*******************************************************************************
+ *                          XXH3 (64 bits, seed 0)
+ *******************************************************************************/
+
+static uint64_t d_mulfold(uint64_t a, uint64_t b) {
+  __uint128_t product = (__uint128_t)a * b;
+  return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static uint64_t d_xxh64avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= D_PRIME64_2;
+  h ^= h >> 29;
+  h *= D_PRIME64_3;
+  return h ^ (h >> 32);
+}
+
+static uint64_t d_xxh3avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= D_PRIME_MX1;
+  return h ^ (h >> 32);
+}
+
+static uint64_t d_rrmxmx(uint64_t h, uint64_t len) {
+  h ^= d_rotl64(h, 49) ^ d_rotl64(h, 24);
+  h *= D_PRIME_MX2;
+  h ^= (h >> 35) + len;
+  h *= D_PRIME_MX2;
+  return h ^ (h >> 28);
+}
+
+static uint64_t d_mix16(const uint8_t *p, const uint8_t *secret) {
+  uint64_t lo = d_read64(p) ^ d_read64(secret);
+  uint64_t hi = d_read64(p + 8) ^ d_read64(secret + 8);
+  return d_mulfold(lo, hi);
+}
+
+static uint64_t d_xxh3_short(const uint8_t *p, uint64_t len) {
+  const uint8_t *s = d_xxhsecret;
+
+  if (len == 0)
+    return d_xxh64avalanche(d_read64(s + 56) ^ d_read64(s + 64));
+
+  if (len <= 3) {
+    uint32_t combined = ((uint32_t)p[0] << 16) | ((uint32_t)p[len >> 1] << 24) |
+                        p[len - 1] | ((uint32_t)len << 8);
+    uint64_t bitflip = d_read32(s) ^ d_read32(s + 4);
+    return d_xxh64avalanche(combined ^ bitflip);
+  }
+
+  if (len <= 8) {
+    uint64_t bitflip = d_read64(s + 8) ^ d_read64(s + 16);
+    uint64_t input = d_read32(p + len - 4) + ((uint64_t)d_read32(p) << 32);
+    return d_rrmxmx(input ^ bitflip, len);
+  }
+
+  if (len <= 16) {
+    uint64_t lo = d_read64(p) ^ (d_read64(s + 24) ^ d_read64(s + 32));
+    uint64_t hi = d_read64(p + len - 8) ^ (d_read64(s + 40) ^ d_read64(s + 48));
+    uint64_t acc = len + __builtin_bswap64(lo) + hi + d_mulfold(lo, hi);
+    return d_xxh3avalanche(acc);
+  }
+
+  uint64_t acc = len * D_PRIME64_1;
+  if (len <= 128) {
+    // pairs of 16 bytes from both ends, as many as the length allows
+    long pairs = (len - 1) / 32;
+    for (long i = pairs; i >= 0; i--) {
+      acc += d_mix16(p + 16 * i, s + 32 * i);
+      acc += d_mix16(p + len - 16 * (i + 1), s + 32 * i + 16);
+    }
+    return d_xxh3avalanche(acc);
+  }
+
+  long rounds = len / 16;
+  for (long i = 0; i < 8; i++)
+    acc += d_mix16(p + 16 * i, s + 16 * i);
+
+  acc = d_xxh3avalanche(acc);
+  for (long i = 8; i < rounds; i++)
+    acc += d_mix16(p + 16 * i, s + 16 * (i - 8) + 3);
+
+  acc += d_mix16(p + len - 16, s + 136 - 17);
+  return d_xxh3avalanche(acc);
+}
+
+static void d_xxh3_stripe(uint64_t acc[8], const uint8_t *p,
+                          const uint8_t *secret) {
+  for (int i = 0; i < 8; i++) {
+    uint64_t value = d_read64(p + 8 * i);
+    uint64_t key = value ^ d_read64(secret + 8 * i);
+    acc[i ^ 1] += value;
+    acc[i] += (uint32_t)key * (key >> 32);
+  }
+}
+
+static void d_xxh3_scramble(uint64_t acc[8]) {
+  const uint8_t *secret = d_xxhsecret + sizeof(d_xxhsecret) - 64;
+  for (int i = 0; i < 8; i++) {
+    uint64_t a = acc[i];
+    a ^= a >> 47;
+    a ^= d_read64(secret + 8 * i);
+    acc[i] = a * D_PRIME32_1;
+  }
+}
+
+static void d_xxh3_stripes(dxxh_t *c, const uint8_t *p, long n) {
+  // 16 stripes per block, the accumulators are scrambled between blocks
+  const long perblock = (sizeof(d_xxhsecret) - 64) / 8;
+  for (long i = 0; i < n; i++, p += 64) {
+    d_xxh3_stripe(c->acc, p, d_xxhsecret + 8 * c->stripes);
+    if (++c->stripes == perblock) {
+      d_xxh3_scramble(c->acc);
+      c->stripes = 0;
+    }
+  }
+}
+
+static void d_xxh3_init(dxxh_t *c) {
+  const uint64_t acc[8] = {D_PRIME32_3, D_PRIME64_1, D_PRIME64_2, D_PRIME64_3,
+                           D_PRIME64_4, D_PRIME32_2, D_PRIME64_5, D_PRIME32_1};
+  memset(c, 0, sizeof(*c));
+  memcpy(c->acc, acc, sizeof(acc));
+}
+
+static void d_xxh3_update(dxxh_t *c, const uint8_t *p, long n) {
+  const long size = sizeof(c->buffer);
+  c->length += n;
+
+  if (c->buffered + n <= size) {
+    memcpy(c->buffer + c->buffered, p, n);
+    c->buffered += n;
+    return;
+  }
+
+  // at least one byte is always left buffered for the final stripe
+  if (c->buffered > 0) {
+    long fill = size - c->buffered;
+    memcpy(c->buffer + c->buffered, p, fill);
+    d_xxh3_stripes(c, c->buffer, size / 64);
+    c->buffered = 0;
+    p += fill;
+    n -= fill;
+  }
+
+  if (n > size) {
+    long whole = (n - 1) / size * size;
+    d_xxh3_stripes(c, p, whole / 64);
+    memcpy(c->buffer + size - 64, p + whole - 64, 64);
+    p += whole;
+    n -= whole;
+  }
+
+  memcpy(c->buffer, p, n);
+  c->buffered = n;
+}
+
+static uint64_t d_xxh3_final(dxxh_t *c) {
+  if (c->length <= 240)
+    return d_xxh3_short(c->buffer, c->length);
+
+  dxxh_t copy = *c;
+  uint8_t last[64];
+  long n = copy.buffered;
+
+  if (n >= 64) {
+    d_xxh3_stripes(&copy, copy.buffer, (n - 1) / 64);
+    memcpy(last, copy.buffer + n - 64, 64);
+  } else {
+    memcpy(last, copy.buffer + sizeof(copy.buffer) - (64 - n), 64 - n);
+    memcpy(last + 64 - n, copy.buffer, n);
+  }
+
+  d_xxh3_stripe(copy.acc, last, d_xxhsecret + sizeof(d_xxhsecret) - 64 - 7);
+
+  uint64_t result = copy.length * D_PRIME64_1;
+  for (int i = 0; i < 4; i++) {
+    const uint8_t *secret = d_xxhsecret + 11 + 16 * i;
+    uint64_t lo = copy.acc[2 * i] ^ d_read64(secret);
+    uint64_t hi = copy.acc[2 * i + 1] ^ d_read64(secret + 8);
+    result += d_mulfold(lo, hi);
+  }
+
+  return d_xxh3avalanche(result);
+}
+
+/*******************************************************************************
+ *                            Tree mode
+ *******************************************************************************/
+
+/*
+ * Tree mode worker: hashes every `step`th leaf from `first`
+ */
+typedef struct {
+  stream_t *stream;
+  long off;
+  long len;
+  long first;
+  long step;
+  long leaf;
+  uint8_t *digests;
+  de_t err;
+} dw_t;
+
+static void *d_treeworker(void *arg) {
+  dw_t *w = arg;
+  uint8_t *buf = malloc(w->leaf);
+  assert(buf != NULL);
+
+  long leaves = (w->len + w->leaf - 1) / w->leaf;
+  for (long i = w->first; i < leaves; i += w->step) {
+    long where = w->off + i * w->leaf;
+    long size = w->len - i * w->leaf < w->leaf ? w->len - i * w->leaf : w->leaf;
+    sb_t mem = {.data = buf, .size = size};
+    long read = 0;
+
+    if (s_readat(w->stream, &mem, where, &read) != se_ok || read != size) {
+      w->err = de_read;
+      break;
+    }
+
+    dc_t c;
+    dd_t d;
+    d_init(&c, dk_sha256);
+    d_update(&c, buf, size);
+    d_final(&c, &d);
+    memcpy(w->digests + 32 * i, d.bytes, 32);
+  }
+
+  free(buf);
+  return NULL;
+}
+
+static de_t d_tree(stream_t *s, long off, long len, dd_t *out) {
+  d_features();
+  const long leaf = 1 << 20;
+  long leaves = (len + leaf - 1) / leaf;
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  uint8_t *digests = malloc(32 * leaves + 1);
+  assert(digests != NULL);
+
+  // streams without descriptor share a stdio position: one thread only
+  long threads = s->type == st_file && fileno(s->handle) >= 0 ? cores : 1;
+  threads = threads < leaves ? threads : leaves;
+  threads = threads > 0 ? threads : 1;
+
+  dw_t *workers = calloc(threads, sizeof(dw_t));
+  pthread_t *ids = calloc(threads, sizeof(pthread_t));
+  assert(workers != NULL && ids != NULL);
+
+  for (long t = 0; t < threads; t++) {
+    workers[t] = (dw_t){.stream = s, .off = off, .len = len, .first = t,
+                        .step = threads, .leaf = leaf, .digests = digests};
+    if (t > 0)
+      pthread_create(&ids[t], NULL, d_treeworker, &workers[t]);
+  }
+
+  d_treeworker(&workers[0]);
+  de_t err = workers[0].err;
+  for (long t = 1; t < threads; t++) {
+    pthread_join(ids[t], NULL);
+    err = err != de_ok ? err : workers[t].err;
+  }
+
+  dc_t root;
+  d_init(&root, dk_sha256);
+  d_update(&root, digests, 32 * leaves);
+  d_final(&root, out);
+
+  free(ids);
+  free(workers);
+  free(digests);
+  return err;
+}
+
+/*******************************************************************************
+ *                      Fuzzy hash (ssdeep, CTPH)
+ *******************************************************************************/
+
+#define D_FNVPRIME 0x01000193U
+#define D_FNVINIT 0x28021967U
+
+static const char d_base64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static uint32_t d_fuzzyroll(dz_t *z, uint8_t c) {
+  z->h2 -= z->h1;
+  z->h2 += 7 * (uint32_t)c;
+  z->h1 += c;
+  z->h1 -= z->window[z->n % 7];
+  z->window[z->n % 7] = c;
+  z->n++;
+  z->h3 = (z->h3 << 5) ^ c;
+  return z->h1 + z->h2 + z->h3;
+}
+
+/*
+ * A trigger at a block size is also one at every smaller block size
+ */
+static void d_fuzzytrigger(dz_t *z, uint32_t roll) {
+  for (int level = 0; level < 32; level++) {
+    uint64_t bs = 3ULL << level;
+    if (roll % bs != bs - 1)
+      return;
+
+    // a full signature only replaces its last character
+    dv8_t *full = &z->full[level / 8];
+    dv8_t *half = &z->half[level / 8];
+    z->sig[level][z->len[level]] = d_base64[(*full)[level % 8] % 64];
+    z->pending[level] = d_base64[(*half)[level % 8] % 64];
+    if (z->len[level] >= 63)
+      continue;
+
+    (*full)[level % 8] = D_FNVINIT;
+    if (z->len[level] < 31) {
+      (*half)[level % 8] = D_FNVINIT;
+      z->pending[level] = '\0';
+    }
+    z->len[level]++;
+  }
+}
+
+/*
+ * Signature without runs of more than 3 identical characters
+ */
+static long d_fuzzyrunless(cstr in, long n, char *out) {
+  long len = 0;
+  for (long i = 0; i < n; i++) {
+    if (i >= 3 && in[i] == in[i - 1] && in[i] == in[i - 2] &&
+        in[i] == in[i - 3])
+      continue;
+    out[len++] = in[i];
+  }
+  return len;
+}
+
+static int d_fuzzycommon(cstr a, long na, cstr b, long nb) {
+  for (long i = 0; i + 7 <= na; i++) {
+    for (long j = 0; j + 7 <= nb; j++) {
+      if (memcmp(a + i, b + j, 7) == 0)
+        return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Edit distance: insertions and deletions cost 1, substitutions 2
+ */
+static long d_fuzzyedits(cstr a, long na, cstr b, long nb) {
+  long row[65];
+  for (long j = 0; j <= nb; j++)
+    row[j] = j;
+
+  for (long i = 1; i <= na; i++) {
+    long diag = row[0];
+    row[0] = i;
+    for (long j = 1; j <= nb; j++) {
+      long up = row[j];
+      long best = diag + (a[i - 1] == b[j - 1] ? 0 : 2);
+      best = up + 1 < best ? up + 1 : best;
+      best = row[j - 1] + 1 < best ? row[j - 1] + 1 : best;
+      row[j] = best;
+      diag = up;
+    }
+  }
+
+  return row[nb];
+}
+
+static long d_fuzzyscore(cstr a, long na, cstr b, long nb, uint64_t bs) {
+  char x[64], y[64];
+  na = d_fuzzyrunless(a, na, x);
+  nb = d_fuzzyrunless(b, nb, y);
+
+  if (!d_fuzzycommon(x, na, y, nb))
+    return 0;
+
+  long score = d_fuzzyedits(x, na, y, nb) * 64 / (na + nb);
+  score = 100 * score / 64;
+  if (score >= 100)
+    return 0;
+
+  // small block sizes can't score more than their signatures allow
+  score = 100 - score;
+  uint64_t cap = bs / 3 * (na < nb ? na : nb);
+  if (bs < (99 + 7) / 7 * 3 && (uint64_t)score > cap)
+    score = cap;
+  return score;
+}
+
+/*
+ * Split "blocksize:signature:signature", signatures of 64 characters at most
+ */
+static int d_fuzzyparse(cstr in, uint64_t *bs, cstr *s1, long *n1, cstr *s2,
+                        long *n2) {
+  char *end;
+  *bs = strtoull(in, &end, 10);
+  if (end == in || *end != ':' || *bs < 3)
+    return 0;
+
+  *s1 = end + 1;
+  cstr colon = strchr(*s1, ':');
+  if (colon == NULL)
+    return 0;
+
+  *n1 = colon - *s1;
+  *s2 = colon + 1;
+  *n2 = strcspn(*s2, ",");
+  return *n1 <= 64 && *n2 <= 64;
+}
+
+/*******************************************************************************
+ *                            Digest functions
+ *******************************************************************************/
+
+de_t d_kind(cstr name, dk_t *out) {
+  assert(name != NULL);
+  assert(out != NULL);
+
+  static const cstr names[] = {"crc32c", "xxh3", "sha256", "tree"};
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    if (strcmp(name, names[i]) == 0) {
+      *out = i;
+      return de_ok;
+    }
+  }
+
+  return de_algo;
+}
+
+de_t d_init(dc_t *out, dk_t kind) {
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+  out->kind = kind;
+
+  switch (kind) {
+  case dk_crc32c:
+    out->crc = 0xFFFFFFFFU;
+    return de_ok;
+  case dk_xxh3:
+    d_xxh3_init(&out->xxh);
+    return de_ok;
+  case dk_sha256:
+    memcpy(out->sha.state, d_sha256h, sizeof(d_sha256h));
+    return de_ok;
+  default:
+    return de_algo;
+  }
+}
+
+de_t d_update(dc_t *c, const void *data, long size) {
+  assert(c != NULL);
+  assert(data != NULL || size == 0);
+
+  switch (c->kind) {
+  case dk_crc32c:
+    c->crc = d_crc32c(c->crc, data, size);
+    return de_ok;
+  case dk_xxh3:
+    d_xxh3_update(&c->xxh, data, size);
+    return de_ok;
+  case dk_sha256:
+    d_sha256_update(&c->sha, data, size);
+    return de_ok;
+  default:
+    return de_algo;
+  }
+}
+
+de_t d_final(dc_t *c, dd_t *out) {
+  assert(c != NULL);
+  assert(out != NULL);
+
+  switch (c->kind) {
+  case dk_crc32c:
+    d_bigendian(out, ~c->crc, 4);
+    return de_ok;
+  case dk_xxh3:
+    d_bigendian(out, d_xxh3_final(&c->xxh), 8);
+    return de_ok;
+  case dk_sha256:
+    d_sha256_final(&c->sha, out);
+    return de_ok;
+  default:
+    return de_algo;
+  }
+}
+
+de_t d_stream(stream_t *s, dk_t kind, long off, long len, dd_t *out) {
+  assert(s != NULL);
+  assert(out != NULL);
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return de_range;
+
+  if (kind == dk_tree)
+    return d_tree(s, off, len, out);
+
+  const long block = 1 << 20;
+  uint8_t *buf = malloc(block);
+  assert(buf != NULL);
+
+  dc_t c;
+  de_t err = d_init(&c, kind);
+  check_de(err, { free(buf); });
+
+  for (long done = 0; done < len;) {
+    long size = len - done < block ? len - done : block;
+    sb_t mem = {.data = buf, .size = size};
+    long read = 0;
+
+    if (s_readat(s, &mem, off + done, &read) != se_ok || read != size) {
+      free(buf);
+      return de_read;
+    }
+
+    d_update(&c, buf, size);
+    done += size;
+  }
+
+  free(buf);
+  return d_final(&c, out);
+}
+
+void d_hex(dd_t *d, str out) {
+  assert(d != NULL);
+  assert(out != NULL);
+
+  for (long i = 0; i < d->size; i++)
+    sprintf(out + 2 * i, "%02x", d->bytes[i]);
+  out[2 * d->size] = '\0';
+}
+
+void d_fuzzyinit(dz_t *out, long size) {
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  // the block size a classic two-pass ssdeep would try first
+  while (out->guess < 30 && (3L << out->guess) * 64 < size)
+    out->guess++;
+
+  for (int v = 0; v < 4; v++) {
+    out->full[v] += D_FNVINIT;
+    out->half[v] += D_FNVINIT;
+  }
+}
+
+void d_fuzzyupdate(dz_t *z, const void *data, long size) {
+  assert(z != NULL);
+  assert(data != NULL || size == 0);
+
+  const uint8_t *p = data;
+  for (long i = 0; i < size; i++) {
+    uint32_t roll = d_fuzzyroll(z, p[i]);
+
+    // the piece hashes of the 32 block sizes, 8 lanes at a time
+    for (int v = 0; v < 4; v++) {
+      z->full[v] = (z->full[v] * D_FNVPRIME) ^ p[i];
+      z->half[v] = (z->half[v] * D_FNVPRIME) ^ p[i];
+    }
+
+    if (roll % 3 == 2)
+      d_fuzzytrigger(z, roll);
+  }
+}
+
+void d_fuzzyfinal(dz_t *z, str out) {
+  assert(z != NULL);
+  assert(out != NULL);
+
+  // smaller block sizes replace the guess until a signature is long enough
+  long level = z->guess;
+  while (level > 0 && z->len[level] < 32)
+    level--;
+
+  uint32_t roll = z->h1 + z->h2 + z->h3;
+  long next = level + 1;
+  long n1 = z->len[level];
+  long n2 = z->len[next] < 31 ? z->len[next] : 31;
+  char s1[65], s2[33];
+
+  // the piece after the last trigger, else the character still pending
+  memcpy(s1, z->sig[level], n1);
+  memcpy(s2, z->sig[next], n2);
+  if (roll != 0) {
+    s1[n1++] = d_base64[z->full[level / 8][level % 8] % 64];
+    s2[n2++] = d_base64[z->half[next / 8][next % 8] % 64];
+  } else {
+    if (n1 == 63 && z->sig[level][63] != '\0')
+      s1[n1++] = z->sig[level][63];
+    if (z->pending[next] != '\0')
+      s2[n2++] = z->pending[next];
+  }
+
+  s1[n1] = '\0';
+  s2[n2] = '\0';
+  snprintf(out, D_FUZZYLEN, "%lu:%s:%s", 3UL << level, s1, s2);
+}
+
+de_t d_fuzzystream(stream_t *s, str out) {
+  assert(s != NULL);
+  assert(out != NULL);
+
+  const long block = 1 << 20;
+  uint8_t *buf = malloc(block);
+  assert(buf != NULL);
+
+  dz_t *z = malloc(sizeof(dz_t));
+  assert(z != NULL);
+  d_fuzzyinit(z, s->size);
+
+  for (long done = 0; done < s->size;) {
+    long size = s->size - done < block ? s->size - done : block;
+    sb_t mem = {.data = buf, .size = size};
+    long read = 0;
+
+    if (s_readat(s, &mem, done, &read) != se_ok || read != size) {
+      free(z);
+      free(buf);
+      return de_read;
+    }
+
+    d_fuzzyupdate(z, buf, size);
+    done += size;
+  }
+
+  d_fuzzyfinal(z, out);
+  free(z);
+  free(buf);
+  return de_ok;
+}
+
+int d_fuzzycompare(cstr a, cstr b) {
+  assert(a != NULL);
+  assert(b != NULL);
+
+  uint64_t bsa, bsb;
+  cstr a1, a2, b1, b2;
+  long na1, na2, nb1, nb2;
+  if (!d_fuzzyparse(a, &bsa, &a1, &na1, &a2, &na2) ||
+      !d_fuzzyparse(b, &bsb, &b1, &nb1, &b2, &nb2))
+    return -1;
+
+  if (bsa == bsb && na1 == nb1 && na2 == nb2 && memcmp(a1, b1, na1) == 0 &&
+      memcmp(a2, b2, na2) == 0)
+    return 100;
+
+  // signatures are only comparable at the same block size
+  if (bsa == bsb) {
+    long s1 = d_fuzzyscore(a1, na1, b1, nb1, bsa);
+    long s2 = d_fuzzyscore(a2, na2, b2, nb2, bsa * 2);
+    return s1 > s2 ? s1 : s2;
+  }
+
+  if (bsa == bsb * 2)
+    return d_fuzzyscore(a1, na1, b2, nb2, bsa);
+
+  if (bsb == bsa * 2)
+    return d_fuzzyscore(a2, na2, b1, nb1, bsb);
+
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stream.h"
+#include "typedef.h"
+
+/*******************************************************************************
+ *                          Digest object definitions
+ *******************************************************************************/
+
+/*
+ * Digest error codes
+ */
+typedef enum { de_ok, de_algo, de_read, de_range } de_t;
+
+/*
+ * Digest algorithms
+ */
+typedef enum { dk_crc32c, dk_xxh3, dk_sha256, dk_tree } dk_t;
+
+/*
+ * SHA-256 state
+ */
+typedef struct {
+  uint32_t state[8];
+  uint8_t buffer[64];
+  long buffered;
+  uint64_t length;
+} dsha_t;
+
+/*
+ * XXH3 (64 bits, seed 0) state
+ */
+typedef struct {
+  uint64_t acc[8];
+  uint8_t buffer[256];
+  long buffered;
+  long stripes;
+  uint64_t length;
+} dxxh_t;
+
+/*
+ * Digest context
+ */
+typedef struct {
+  dk_t kind;
+  union {
+    uint32_t crc;
+    dxxh_t xxh;
+    dsha_t sha;
+  };
+} dc_t;
+
+/*
+ * Digest value, most significant byte first
+ */
+typedef struct {
+  uint8_t bytes[32];
+  long size;
+} dd_t;
+
+/*
+ * 8 lanes of 4 bytes
+ */
+typedef uint32_t dv8_t __attribute__((vector_size(32)));
+
+/*
+ * Context-triggered piecewise hash (ssdeep) state. Every block size from 3
+ * to 3 * 2^31 is hashed at once so the stream is read a single time. A full
+ * signature keeps the character of its last trigger after its 63 others, and
+ * `pending` is that of the half signature once it is 32 long.
+ */
+typedef struct {
+  uint32_t h1;
+  uint32_t h2;
+  uint32_t h3;
+  uint32_t n;
+  uint8_t window[7];
+  dv8_t full[4];
+  dv8_t half[4];
+  char sig[32][64];
+  uint8_t len[32];
+  char pending[32];
+  long guess;
+} dz_t;
+
+/*
+ * Length of a formatted fuzzy digest, null included
+ */
+#define D_FUZZYLEN 128
+
+/*******************************************************************************
+ *                            Digest functions
+ *******************************************************************************/
+
+/*
+ * Get an algorithm from its name
+ */
+de_t d_kind(cstr name, dk_t *out);
+
+/*
+ * Init a digest context. The tree mode is only available on streams.
+ */
+de_t d_init(dc_t *out, dk_t kind);
+
+/*
+ * Hash more data
+ */
+de_t d_update(dc_t *c, const void *data, long size);
+
+/*
+ * Get the digest of all data hashed
+ */
+de_t d_final(dc_t *c, dd_t *out);
+
+/*
+ * Hash `len` bytes of a stream from `off` in large blocks. The tree mode
+ * hashes 1 MiB leaves on every core, then the list of leaf digests.
+ */
+de_t d_stream(stream_t *s, dk_t kind, long off, long len, dd_t *out);
+
+/*
+ * Format a digest as a null-terminated hex string (65 bytes at most)
+ */
+void d_hex(dd_t *d, str out);
+
+/*
+ * Init a fuzzy hash for a total of `size` bytes
+ */
+void d_fuzzyinit(dz_t *out, long size);
+
+/*
+ * Fuzzy hash more data
+ */
+void d_fuzzyupdate(dz_t *z, const void *data, long size);
+
+/*
+ * Format the fuzzy digest as "blocksize:signature:signature"
+ */
+void d_fuzzyfinal(dz_t *z, str out);
+
+/*
+ * Fuzzy hash a whole stream
+ */
+de_t d_fuzzystream(stream_t *s, str out);
+
+/*
+ * Similarity of two fuzzy digests from 0 to 100, or -1 if one is malformed
+ */
+int d_fuzzycompare(cstr a, cstr b);
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "../digest.h"
+#include "../test.h"
+
+/*******************************************************************************
+ *                            Test data
+ *******************************************************************************/
+
+cstr d_path = "digest.bin";
+
+// xxh3 of d_util_data(len), one per short and long code path
+long d_xxhlens[] = {0, 3, 8, 16, 100, 200, 1000, 5000};
+cstr d_xxhs[] = {
+    "2d06800538d394c2", "a9088dda485b481c", "60539db630471163",
+    "b8c859b0f030b585", "b5937857f0d78c9f", "746cd0025327bf5b",
+    "6c4f14bd97bd9e82", "799aaddd7339581d",
+};
+
+/*******************************************************************************
+ *                       Test utility functions
+ *******************************************************************************/
+
+uint8_t *d_util_data(long len) {
+  uint8_t *data = malloc(len + 1);
+  for (long i = 0; i < len; i++) {
+    data[i] = i * 7 + 3;
+  }
+  return data;
+}
+
+void d_util_hash(dk_t kind, const void *data, long len, long chunk, str out) {
+  dc_t c;
+  dd_t d;
+  d_init(&c, kind);
+  for (long done = 0; done < len; done += chunk) {
+    d_update(&c, (const uint8_t *)data + done,
+             len - done < chunk ? len - done : chunk);
+  }
+  d_final(&c, &d);
+  d_hex(&d, out);
+}
+
+/*******************************************************************************
+ *                           Test cases
+ *******************************************************************************/
+
+void d_test_kind(void) {
+  // arrange
+  dk_t kind = dk_crc32c;
+
+  // act
+  de_t found = d_kind("tree", &kind);
+  de_t missing = d_kind("md5", &kind);
+
+  // assert
+  t_exp("%i", de_ok, "%i", found, {});
+  t_exp("%i", de_algo, "%i", missing, {});
+  t_exp("%i", dk_tree, "%i", kind, {});
+  t_ok();
+}
+
+void d_test_crc32c(void) {
+  // arrange
+  char out[65];
+  char *data = "123456789";
+
+  // act
+  d_util_hash(dk_crc32c, data, 9, 9, out);
+
+  // assert
+  t_sexp("e3069283", 9L, out, strlen(out) + 1, {});
+  t_ok();
+}
+
+void d_test_sha256(void) {
+  // arrange
+  char abc[65];
+  char whole[65];
+  char chunked[65];
+  uint8_t *data = d_util_data(5000);
+
+  // act
+  d_util_hash(dk_sha256, "abc", 3, 3, abc);
+  d_util_hash(dk_sha256, data, 5000, 5000, whole);
+  d_util_hash(dk_sha256, data, 5000, 61, chunked);
+
+  // assert
+  cstr exp = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+  t_sexp(exp, 65L, abc, strlen(abc) + 1, { free(data); });
+  exp = "34398b85297bf7d9dfb59b8d511d8bbb44ab23e891570e4395e7871475fc8afb";
+  t_sexp(exp, 65L, whole, strlen(whole) + 1, { free(data); });
+  t_sexp(exp, 65L, chunked, strlen(chunked) + 1, { free(data); });
+  free(data);
+  t_ok();
+}
+
+void d_test_xxh3(void) {
+  // arrange
+  char whole[65];
+  char chunked[65];
+  uint8_t *data = d_util_data(5000);
+
+  for (int i = 0; i < 8; i++) {
+    // act
+    d_util_hash(dk_xxh3, data, d_xxhlens[i], d_xxhlens[i] + 1, whole);
+    d_util_hash(dk_xxh3, data, d_xxhlens[i], 7, chunked);
+
+    // assert
+    t_sexp(d_xxhs[i], 17L, whole, strlen(whole) + 1, { free(data); });
+    t_sexp(d_xxhs[i], 17L, chunked, strlen(chunked) + 1, { free(data); });
+  }
+
+  free(data);
+  t_ok();
+}
+
+void d_test_stream_tree(void) {
+  // arrange
+  long len = 3 * (1 << 20) + 5;
+  uint8_t *data = d_util_data(len);
+  FILE *file = fopen(d_path, "w");
+  fwrite(data, 1, len, file);
+  fclose(file);
+  free(data);
+
+  stream_t stream;
+  s_openfile(&stream, d_path, sm_read);
+  dd_t d;
+  char out[65];
+
+  // act
+  de_t error = d_stream(&stream, dk_tree, 0, len, &d);
+  de_t range = d_stream(&stream, dk_sha256, 1, len, &d);
+  d_hex(&d, out);
+
+  // assert
+  s_close(&stream);
+  remove(d_path);
+  cstr exp = "a54f99aae664bc4ea8179c2a7db359a1561db3e4fea959da047e019c01b66906";
+  t_exp("%i", de_ok, "%i", error, {});
+  t_exp("%i", de_range, "%i", range, {});
+  t_sexp(exp, 65L, out, strlen(out) + 1, {});
+  t_ok();
+}
+
+void d_test_fuzzy(void) {
+  // arrange
+  uint8_t *data = d_util_data(5000);
+  char whole[D_FUZZYLEN];
+  char chunked[D_FUZZYLEN];
+  dz_t z;
+
+  // act
+  d_fuzzyinit(&z, 5000);
+  d_fuzzyupdate(&z, data, 5000);
+  d_fuzzyfinal(&z, whole);
+  d_fuzzyinit(&z, 5000);
+  for (long i = 0; i < 5000; i += 333) {
+    d_fuzzyupdate(&z, data + i, 5000 - i < 333 ? 5000 - i : 333);
+  }
+  d_fuzzyfinal(&z, chunked);
+
+  // assert
+  free(data);
+  cstr exp = "6:x4snYM4M4sYo+HMWgppNIMx4QZIE3XN6HUIYhDCzLURerEYLz44rzXsB4E9KIFCA:X";
+  long len = strlen(exp) + 1;
+  t_sexp(exp, len, whole, strlen(whole) + 1, {});
+  t_sexp(exp, len, chunked, strlen(chunked) + 1, {});
+  t_ok();
+}
+
+void d_test_fuzzy_pending(void) {
+  // arrange: ending in zeros, the rolling hash is 0 at the end
+  uint8_t *data = calloc(12016, 1);
+  uint64_t seed = 1;
+  for (long i = 0; i < 12000; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    data[i] = seed >> 56;
+  }
+  char out[D_FUZZYLEN];
+  dz_t z;
+
+  // act
+  d_fuzzyinit(&z, 12016);
+  d_fuzzyupdate(&z, data, 12016);
+  d_fuzzyfinal(&z, out);
+
+  // assert: both signatures end with the character of their last trigger
+  free(data);
+  cstr exp =
+      "192:+UrNeKxqgr5vbeEmzAy0vZV6JFPnzJDNA2MsMtRg5D1ak3QLZfjJqnzokP5Crq67:"
+      "+Ur/r5vber5MZVOFPnzJ5lNikMk3Hd5I";
+  t_sexp(exp, strlen(exp) + 1, out, strlen(out) + 1, {});
+  t_ok();
+}
+
+void d_test_fuzzy_compare(void) {
+  // arrange
+  cstr a = "3072:UWYP/ol81U/VjBItXmi2g7HIOJ6AjcDKUp2tEz:UWYmyU/VjytXjTlwAQjQiz";
+  cstr b = "3072:UWYP/ol81U/VjBItXmi2g7HIOJ6AjcDKUp2tEA:UWYmyU/VjytXjTlwAQjQiA";
+  cstr c = "6144:UWYmyU/VjytXjTlwAQjQiz:Qz";
+  cstr d = "3072:ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghij:klmnopqrstuvwxyz0123";
+
+  // act
+  int same = d_fuzzycompare(a, a);
+  int close = d_fuzzycompare(a, b);
+  int doubled = d_fuzzycompare(a, c);
+  int none = d_fuzzycompare(a, d);
+  int malformed = d_fuzzycompare(a, "3072:abc");
+
+  // assert
+  t_exp("%i", 100, "%i", same, {});
+  t_exp("%i", 1, "%i", (close > 80 && close < 100), {});
+  t_exp("%i", 100, "%i", doubled, {});
+  t_exp("%i", 0, "%i", none, {});
+  t_exp("%i", -1, "%i", malformed, {});
+  t_ok();
+}
+
+int main(int argc, char **argv) {
+  d_test_kind();
+  d_test_crc32c();
+  d_test_sha256();
+  d_test_xxh3();
+  d_test_stream_tree();
+  d_test_fuzzy();
+  d_test_fuzzy_pending();
+  d_test_fuzzy_compare();
+  return 0;
+}
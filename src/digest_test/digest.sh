@@ -0,0 +1,15 @@
+#
+# Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+#
+
+files=("digest.c" "../digest.c" "../stream.c")
+output="digest.elf"
+
+gcc ${files[@]} -o $output -ggdb -pthread
+if [ $? -eq 0 ]; then
+  chmod +x $output
+
+  if [[ "$#" -gt 0 && "$1" == "run" ]]; then
+    "./${output}"
+  fi
+fi
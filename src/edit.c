@@ -0,0 +1,1111 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#define _GNU_SOURCE
+#include "edit.h"
+
+/*******************************************************************************
+ *                       Internal utility functions
+ *******************************************************************************/
+
+static long e_total(ep_t *p) { return p != NULL ? p->total : 0; }
+
+static long e_count(ep_t *p) { return p != NULL ? p->count : 0; }
+
+static void e_update(ep_t *p) {
+  p->total = e_total(p->left) + p->size + e_total(p->right);
+  p->count = e_count(p->left) + 1 + e_count(p->right);
+}
+
+static ep_t *e_node(et_t *e, int added, long offset, long size) {
+  ep_t *p = malloc(sizeof(ep_t));
+  assert(p != NULL);
+
+  // xorshift64: random priorities keep the treap balanced
+  e->seed ^= e->seed << 13;
+  e->seed ^= e->seed >> 7;
+  e->seed ^= e->seed << 17;
+
+  *p = (ep_t){.offset = offset, .size = size, .total = size, .count = 1,
+              .priority = e->seed >> 32, .added = added};
+  return p;
+}
+
+static void e_freenode(ep_t *p) {
+  if (p == NULL)
+    return;
+
+  e_freenode(p->left);
+  e_freenode(p->right);
+  free(p);
+}
+
+static ep_t *e_merge(ep_t *a, ep_t *b) {
+  if (a == NULL)
+    return b;
+  if (b == NULL)
+    return a;
+
+  if (a->priority > b->priority) {
+    a->right = e_merge(a->right, b);
+    e_update(a);
+    return a;
+  }
+
+  b->left = e_merge(a, b->left);
+  e_update(b);
+  return b;
+}
+
+/*
+ * Split the pieces of `p` at position `at`, cutting one piece in two if needed
+ */
+static void e_split(et_t *e, ep_t *p, long at, ep_t **l, ep_t **r) {
+  if (p == NULL) {
+    *l = *r = NULL;
+    return;
+  }
+
+  long left = e_total(p->left);
+  if (at <= left) {
+    e_split(e, p->left, at, l, &p->left);
+    e_update(p);
+    *r = p;
+  } else if (at >= left + p->size) {
+    e_split(e, p->right, at - left - p->size, &p->right, r);
+    e_update(p);
+    *l = p;
+  } else {
+    long cut = at - left;
+    ep_t *tail = e_node(e, p->added, p->offset + cut, p->size - cut);
+    p->size = cut;
+    *r = e_merge(tail, p->right);
+    p->right = NULL;
+    e_update(p);
+    *l = p;
+  }
+}
+
+static ep_t *e_add(et_t *e, const void *data, long size) {
+  if (e->addsize + size > e->addalloc) {
+    e->addalloc = e->addalloc > 0 ? e->addalloc : 256;
+    while (e->addsize + size > e->addalloc)
+      e->addalloc *= 2;
+    e->added = realloc(e->added, e->addalloc);
+    assert(e->added != NULL);
+  }
+
+  memcpy(e->added + e->addsize, data, size);
+  e->addsize += size;
+  return e_node(e, 1, e->addsize - size, size);
+}
+
+/*
+ * Put the pieces `p`, `newsize` bytes, in place of `oldsize` bytes at `where`
+ * and get the pieces taken out
+ */
+static ep_t *e_replace(et_t *e, long where, long oldsize, ep_t *p,
+                       long newsize) {
+  ep_t *l, *m, *r;
+  e_split(e, e->root, where, &l, &r);
+  e_split(e, r, oldsize, &m, &r);
+  e->root = e_merge(e_merge(l, p), r);
+  e->size += newsize - oldsize;
+  e->pieces = e_count(e->root);
+  return m;
+}
+
+/*
+ * Add an edit to the history, dropping the edits undone
+ */
+static eu_t *e_record(et_t *e, long where, long oldsize, long newsize) {
+  ej_t *h = &e->history;
+  while (h->num > h->done)
+    e_freenode(h->edits[--h->num].pieces);
+
+  if (h->num >= h->alloc) {
+    h->alloc = h->alloc > 0 ? h->alloc * 2 : 256;
+    h->edits = realloc(h->edits, sizeof(eu_t) * h->alloc);
+    assert(h->edits != NULL);
+  }
+
+  // the edits after the first of a group join it
+  long last = h->num > 0 ? h->edits[h->num - 1].group : 0;
+  eu_t *u = &h->edits[h->num++];
+  *u = (eu_t){.where = where, .oldsize = oldsize, .newsize = newsize,
+              .group = h->joining ? last : last + 1};
+  h->joining = h->open > 0;
+  h->done = h->num;
+  return u;
+}
+
+/*
+ * Window of a replace: the matches from `start` to `end` of the block read
+ * at `where`, with the gaps between them, substituted as `size` bytes
+ */
+typedef struct {
+  long start;
+  long end;
+  uint8_t *out;
+  long size;
+} ew_t;
+
+/*
+ * Splice a window in, the windows before in its block having moved it by
+ * `shift` bytes, and close it
+ */
+static ee_t e_window(et_t *e, long where, ew_t *w, long *shift) {
+  long oldsize = w->end - w->start;
+  ee_t err = e_splice(e, where + *shift + w->start, oldsize, w->out, w->size);
+  *shift += w->size - oldsize;
+  w->start = -1;
+  w->size = 0;
+  return err;
+}
+
+/*
+ * Read the part of [where, where + size) held by the subtree `p`, which
+ * starts at `base`
+ */
+static ee_t e_readnode(et_t *e, ep_t *p, long base, uint8_t *out, long where,
+                       long size) {
+  if (p == NULL)
+    return ee_ok;
+
+  ee_t err = ee_ok;
+  long start = base + e_total(p->left);
+  long end = start + p->size;
+  if (where < start)
+    err = e_readnode(e, p->left, base, out, where, size);
+
+  long from = where > start ? where : start;
+  long to = where + size < end ? where + size : end;
+  if (err == ee_ok && from < to) {
+    long at = p->offset + from - start;
+    if (p->added) {
+      memcpy(out + from - where, e->added + at, to - from);
+    } else {
+      sb_t mem = {.data = out + from - where, .size = to - from};
+      long read = 0;
+      if (s_readat(e->original, &mem, at, &read) != se_ok ||
+          read != to - from)
+        err = ee_read;
+    }
+  }
+
+  if (err == ee_ok && where + size > end)
+    err = e_readnode(e, p->right, end, out, where, size);
+  return err;
+}
+
+static ssize_t e_cookieread(void *cookie, char *buf, size_t size) {
+  et_t *e = cookie;
+  long read = 0;
+  if (e_read(e, buf, e->cursor, size, &read) != ee_ok)
+    return -1;
+
+  e->cursor += read;
+  return read;
+}
+
+static int e_cookieseek(void *cookie, off64_t *where, int whence) {
+  et_t *e = cookie;
+  long base = whence == SEEK_SET ? 0 : whence == SEEK_CUR ? e->cursor : e->size;
+  if (base + *where < 0)
+    return -1;
+
+  e->cursor = base + *where;
+  *where = e->cursor;
+  return 0;
+}
+
+/*
+ * Piece and its position in the edited content
+ */
+typedef struct {
+  long pos;
+  ep_t *piece;
+} ei_t;
+
+/*
+ * Pieces in order
+ */
+typedef struct {
+  ei_t *items;
+  long num;
+  long alloc;
+} el_t;
+
+static void e_push(el_t *list, ei_t item) {
+  if (list->num >= list->alloc) {
+    list->alloc = list->alloc > 0 ? list->alloc * 2 : 256;
+    list->items = realloc(list->items, sizeof(ei_t) * list->alloc);
+    assert(list->items != NULL);
+  }
+
+  list->items[list->num++] = item;
+}
+
+static void e_collect(ep_t *p, long *pos, el_t *out) {
+  if (p == NULL)
+    return;
+
+  e_collect(p->left, pos, out);
+  e_push(out, (ei_t){*pos, p});
+  *pos += p->size;
+  e_collect(p->right, pos, out);
+}
+
+/*
+ * Tell if every original byte is still where it was
+ */
+static int e_inplace(et_t *e, el_t *list) {
+  if (e->size != e->original->size)
+    return 0;
+
+  for (long i = 0; i < list->num; i++) {
+    ep_t *p = list->items[i].piece;
+    if (!p->added && p->offset != list->items[i].pos)
+      return 0;
+  }
+  return 1;
+}
+
+static void e_sidepath(cstr path, cstr ext, char out[PATH_MAX]) {
+  snprintf(out, PATH_MAX, "%s.%s", path, ext);
+}
+
+/*
+ * Make a rename or an unlink in the directory of `path` durable
+ */
+static void e_syncdir(cstr path) {
+  char dir[PATH_MAX];
+  snprintf(dir, sizeof(dir), "%s", path);
+  char *slash = strrchr(dir, '/');
+  if (slash == NULL)
+    strcpy(dir, ".");
+  else
+    slash[slash == dir] = '\0';
+
+  int fd = open(dir, O_RDONLY | O_DIRECTORY);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+}
+
+static ee_t e_writeall(int fd, const uint8_t *p, long size) {
+  while (size > 0) {
+    ssize_t n = write(fd, p, size);
+    if (n <= 0)
+      return ee_write;
+    p += n;
+    size -= n;
+  }
+  return ee_ok;
+}
+
+/*
+ * Copy `size` bytes at `off` of `in` to the end of `out`, in the kernel when
+ * the filesystem allows it (reflinks on btrfs and xfs)
+ */
+static ee_t e_copy(int in, long off, int out, long size) {
+  loff_t from = off;
+  while (size > 0) {
+    ssize_t n = copy_file_range(in, &from, out, NULL, size, 0);
+    if (n > 0) {
+      size -= n;
+      continue;
+    }
+
+    if (n == 0)
+      return ee_read;
+    if (errno != EXDEV && errno != ENOSYS && errno != EINVAL &&
+        errno != EOPNOTSUPP)
+      return ee_write;
+
+    // no kernel copy between these files: through a buffer
+    errno = 0;
+    const long block = 1 << 20;
+    uint8_t *buf = malloc(block);
+    assert(buf != NULL);
+    while (size > 0) {
+      ssize_t got = pread(in, buf, size < block ? size : block, from);
+      if (got <= 0 || e_writeall(out, buf, got) != ee_ok) {
+        free(buf);
+        return got <= 0 ? ee_read : ee_write;
+      }
+      from += got;
+      size -= got;
+    }
+    free(buf);
+  }
+  return ee_ok;
+}
+
+/*
+ * Journal: "HXJ1" and 4 zeros, the xxh3 of what follows, the number of
+ * spans, then every span as its offset, its size and its bytes. Numbers are
+ * 64 bits little endian.
+ */
+static ee_t e_writejournal(et_t *e, el_t *list, cstr path) {
+  long bytes = 24;
+  uint64_t spans = 0;
+  for (long i = 0; i < list->num; i++) {
+    if (list->items[i].piece->added) {
+      bytes += 16 + list->items[i].piece->size;
+      spans++;
+    }
+  }
+
+  uint8_t *buf = calloc(bytes, 1);
+  assert(buf != NULL);
+  memcpy(buf, "HXJ1", 4);
+  memcpy(buf + 16, &spans, 8);
+
+  long at = 24;
+  for (long i = 0; i < list->num; i++) {
+    ep_t *p = list->items[i].piece;
+    if (!p->added)
+      continue;
+
+    uint64_t span[2] = {list->items[i].pos, p->size};
+    memcpy(buf + at, span, 16);
+    memcpy(buf + at + 16, e->added + p->offset, p->size);
+    at += 16 + p->size;
+  }
+
+  dc_t c;
+  dd_t d;
+  d_init(&c, dk_xxh3);
+  d_update(&c, buf + 16, bytes - 16);
+  d_final(&c, &d);
+  memcpy(buf + 8, d.bytes, 8);
+
+  char journal[PATH_MAX];
+  e_sidepath(path, "hxj", journal);
+  int fd = open(journal, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  ee_t err = fd >= 0 ? e_writeall(fd, buf, bytes) : ee_write;
+  if (err == ee_ok && fsync(fd) != 0)
+    err = ee_write;
+
+  if (fd >= 0)
+    close(fd);
+  free(buf);
+  e_syncdir(path);
+  return err;
+}
+
+static ee_t e_saveinplace(et_t *e, el_t *list, cstr path, es_t *out) {
+  ee_t err = e_writejournal(e, list, path);
+  if (err != ee_ok)
+    return err;
+
+  int fd = open(path, O_WRONLY);
+  if (fd < 0)
+    return ee_write;
+
+  // adjacent edited pieces are written by one call
+  const long batch = 64;
+  struct iovec iov[64];
+  for (long i = 0; i < list->num && err == ee_ok;) {
+    if (!list->items[i].piece->added) {
+      i++;
+      continue;
+    }
+
+    long at = list->items[i].pos, size = 0, n = 0;
+    while (i < list->num && n < batch && list->items[i].piece->added &&
+           list->items[i].pos == at + size) {
+      ep_t *p = list->items[i++].piece;
+      iov[n++] = (struct iovec){e->added + p->offset, p->size};
+      size += p->size;
+    }
+
+    if (pwritev(fd, iov, n, at) != size)
+      err = ee_write;
+    out->written += size;
+  }
+
+  // the journal goes only once the data is durable
+  if (err == ee_ok && fsync(fd) != 0)
+    err = ee_write;
+  close(fd);
+
+  if (err == ee_ok) {
+    char journal[PATH_MAX];
+    e_sidepath(path, "hxj", journal);
+    unlink(journal);
+    e_syncdir(path);
+  }
+  return err;
+}
+
+static ee_t e_saverename(et_t *e, el_t *list, cstr path, es_t *out) {
+  int in = fileno(e->original->handle);
+  struct stat st;
+  if (fstat(in, &st) != 0)
+    return ee_read;
+
+  char tmp[PATH_MAX];
+  e_sidepath(path, "hxtmp", tmp);
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, st.st_mode & 0777);
+  if (fd < 0)
+    return ee_write;
+
+  ee_t err = ee_ok;
+  for (long i = 0; i < list->num && err == ee_ok; i++) {
+    ep_t *p = list->items[i].piece;
+    if (p->added) {
+      err = e_writeall(fd, e->added + p->offset, p->size);
+      out->written += p->size;
+    } else {
+      err = e_copy(in, p->offset, fd, p->size);
+      out->copied += p->size;
+    }
+  }
+
+  // the new file is complete and durable before it replaces the old one
+  if (err == ee_ok && fsync(fd) != 0)
+    err = ee_write;
+  close(fd);
+
+  if (err == ee_ok && rename(tmp, path) != 0)
+    err = ee_write;
+
+  if (err != ee_ok)
+    unlink(tmp);
+  e_syncdir(path);
+  return err;
+}
+
+/*
+ * Patch being written or applied, with the digests of its own bytes, of the
+ * source and of the target
+ */
+typedef struct {
+  et_t *edit;
+  FILE *file;
+  dc_t patch;
+  dc_t source;
+  dc_t target;
+  uint8_t *buf;
+  ee_t err;
+} ex_t;
+
+/*
+ * Pending patch record: keep `copy` source bytes, drop `skip` of them, then
+ * add the bytes of the pieces `first` to `last` - 1
+ */
+typedef struct {
+  long copy;
+  long skip;
+  long first;
+  long last;
+  long size;
+} er_t;
+
+static void e_put(ex_t *x, const void *data, long size) {
+  if (x->err == ee_ok && (long)fwrite(data, 1, size, x->file) != size)
+    x->err = ee_write;
+  d_update(&x->patch, data, size);
+}
+
+static int e_get(ex_t *x, void *out, long size) {
+  if (x->err != ee_ok)
+    return 0;
+  if ((long)fread(out, 1, size, x->file) != size) {
+    x->err = ee_patch;
+    return 0;
+  }
+  d_update(&x->patch, out, size);
+  return 1;
+}
+
+static void e_putvarint(ex_t *x, uint64_t value) {
+  uint8_t bytes[10];
+  int n = 0;
+  do {
+    bytes[n] = value & 0x7F;
+    value >>= 7;
+    bytes[n++] |= value > 0 ? 0x80 : 0;
+  } while (value > 0);
+  e_put(x, bytes, n);
+}
+
+static long e_getvarint(ex_t *x) {
+  uint64_t value = 0;
+  uint8_t byte = 0x80;
+  for (int shift = 0; byte & 0x80; shift += 7) {
+    if (shift > 56 || !e_get(x, &byte, 1)) {
+      x->err = ee_patch;
+      return -1;
+    }
+    value |= (uint64_t)(byte & 0x7F) << shift;
+  }
+  return value <= INT64_MAX ? (long)value : -1;
+}
+
+/*
+ * Read `size` original bytes at `from` into the digests given, and into the
+ * patch when `write` is set
+ */
+static void e_original(ex_t *x, long from, long size, dc_t *source,
+                       dc_t *target, int write) {
+  const long block = 1 << 20;
+  for (long done = 0; done < size && x->err == ee_ok;) {
+    long n = size - done < block ? size - done : block;
+    sb_t mem = {.data = x->buf, .size = n};
+    long read = 0;
+
+    if (s_readat(x->edit->original, &mem, from + done, &read) != se_ok ||
+        read != n) {
+      x->err = ee_read;
+      return;
+    }
+
+    if (source != NULL)
+      d_update(source, x->buf, n);
+    if (target != NULL)
+      d_update(target, x->buf, n);
+    if (write)
+      e_put(x, x->buf, n);
+    done += n;
+  }
+}
+
+static void e_flush(ex_t *x, el_t *list, er_t *r) {
+  if (r->copy == 0 && r->skip == 0 && r->size == 0)
+    return;
+
+  e_putvarint(x, r->copy);
+  e_putvarint(x, r->skip);
+  e_putvarint(x, r->size);
+  for (long i = r->first; i < r->last; i++) {
+    ep_t *p = list->items[i].piece;
+    if (p->added)
+      e_put(x, x->edit->added + p->offset, p->size);
+    else
+      e_original(x, p->offset, p->size, NULL, NULL, 1);
+  }
+  memset(r, 0, sizeof(*r));
+}
+
+/*
+ * Move `size` bytes from the source to the digests given, and to `out` when
+ * not NULL
+ */
+static void e_pass(ex_t *x, int in, long size, FILE *out, int keep) {
+  const long block = 1 << 20;
+  while (size > 0 && x->err == ee_ok) {
+    long n = size < block ? size : block;
+    if (read(in, x->buf, n) != n) {
+      x->err = ee_source;
+      return;
+    }
+
+    d_update(&x->source, x->buf, n);
+    if (keep) {
+      d_update(&x->target, x->buf, n);
+      if ((long)fwrite(x->buf, 1, n, out) != n)
+        x->err = ee_write;
+    }
+    size -= n;
+  }
+}
+
+static void e_literal(ex_t *x, long size, FILE *out) {
+  const long block = 1 << 20;
+  while (size > 0 && x->err == ee_ok) {
+    long n = size < block ? size : block;
+    if (!e_get(x, x->buf, n))
+      return;
+
+    d_update(&x->target, x->buf, n);
+    if ((long)fwrite(x->buf, 1, n, out) != n)
+      x->err = ee_write;
+    size -= n;
+  }
+}
+
+/*******************************************************************************
+ *                            Edit functions
+ *******************************************************************************/
+
+ee_t e_init(et_t *out, stream_t *original) {
+  assert(out != NULL);
+  assert(original != NULL);
+  memset(out, 0, sizeof(*out));
+
+  out->original = original;
+  out->size = original->size;
+  out->seed = 0x9E3779B97F4A7C15ULL;
+  if (out->size > 0)
+    out->root = e_node(out, 0, 0, out->size);
+  out->pieces = e_count(out->root);
+  return ee_ok;
+}
+
+ee_t e_overwrite(et_t *e, long where, const void *data, long size) {
+  return e_splice(e, where, size, data, size);
+}
+
+ee_t e_insert(et_t *e, long where, const void *data, long size) {
+  return e_splice(e, where, 0, data, size);
+}
+
+ee_t e_delete(et_t *e, long where, long size) {
+  return e_splice(e, where, size, NULL, 0);
+}
+
+ee_t e_splice(et_t *e, long where, long oldsize, const void *data,
+              long newsize) {
+  assert(e != NULL);
+  assert(data != NULL || newsize == 0);
+
+  if (where < 0 || oldsize < 0 || newsize < 0 || where + oldsize > e->size)
+    return ee_range;
+
+  if (oldsize == 0 && newsize == 0)
+    return ee_ok;
+
+  eu_t *u = e_record(e, where, oldsize, newsize);
+  ep_t *p = newsize > 0 ? e_add(e, data, newsize) : NULL;
+  u->pieces = e_replace(e, where, oldsize, p, newsize);
+  return ee_ok;
+}
+
+ee_t e_replaceall(et_t *e, long where, long size, const void *find,
+                  long fsize, const void *with, long rsize, long *count) {
+  assert(e != NULL);
+  assert(find != NULL);
+  assert(with != NULL || rsize == 0);
+  assert(count != NULL);
+  *count = 0;
+
+  if (where < 0 || size < 0 || fsize < 1 || rsize < 0 ||
+      where + size > e->size)
+    return ee_range;
+
+  // a gap between two matches shorter than the pieces it would take is
+  // copied with them, so that a run of matches is one splice and one piece
+  const long gap = 2 * sizeof(ep_t) + sizeof(eu_t);
+  const long block = 1 << 20;
+  const long cap = block + gap + rsize;
+  uint8_t *buf = malloc(block + fsize);
+  ew_t w = {.start = -1, .out = malloc(cap)};
+  assert(buf != NULL && w.out != NULL);
+
+  ee_t err = ee_ok;
+  long end = where + size;
+  e_begin(e);
+  while (err == ee_ok && end - where >= fsize) {
+    long n = end - where < block + fsize - 1 ? end - where : block + fsize - 1;
+    long read, last = 0, shift = 0;
+    err = e_read(e, buf, where, n, &read);
+
+    // matches starting in the block, the bytes after it only ending one
+    long scanned = n - fsize + 1 < block ? n - fsize + 1 : block;
+    uint8_t *m = err == ee_ok ? memmem(buf, n, find, fsize) : NULL;
+    for (; m != NULL && m - buf < scanned;
+         m = memmem(buf + last, n - last, find, fsize)) {
+      long at = m - buf;
+      long grown = w.size + at - w.end + rsize;
+      if (w.start >= 0 && (at - w.end > gap || grown > cap)) {
+        err = e_window(e, where, &w, &shift);
+        if (err != ee_ok)
+          break;
+      }
+
+      if (w.start < 0)
+        w = (ew_t){.start = at, .end = at, .out = w.out};
+      memcpy(w.out + w.size, buf + w.end, at - w.end);
+      memcpy(w.out + w.size + at - w.end, with, rsize);
+      w.size += at - w.end + rsize;
+      w.end = last = at + fsize;
+      (*count)++;
+    }
+
+    if (err == ee_ok && w.start >= 0)
+      err = e_window(e, where, &w, &shift);
+
+    where += (last > scanned ? last : scanned) + shift;
+    end += shift;
+  }
+  e_end(e);
+
+  free(w.out);
+  free(buf);
+  return err;
+}
+
+void e_begin(et_t *e) {
+  assert(e != NULL);
+  if (e->history.open++ == 0)
+    e->history.joining = 0;
+}
+
+void e_end(et_t *e) {
+  assert(e != NULL);
+  assert(e->history.open > 0);
+  if (--e->history.open == 0)
+    e->history.joining = 0;
+}
+
+ee_t e_undo(et_t *e, long *where) {
+  assert(e != NULL);
+  assert(where != NULL);
+
+  ej_t *h = &e->history;
+  if (h->done == 0)
+    return ee_range;
+
+  // the pieces removed go back, the ones added wait for a redo
+  long group = h->edits[h->done - 1].group;
+  *where = e->size;
+  while (h->done > 0 && h->edits[h->done - 1].group == group) {
+    eu_t *u = &h->edits[--h->done];
+    u->pieces = e_replace(e, u->where, u->newsize, u->pieces, u->oldsize);
+    *where = u->where < *where ? u->where : *where;
+  }
+  return ee_ok;
+}
+
+ee_t e_redo(et_t *e, long *where) {
+  assert(e != NULL);
+  assert(where != NULL);
+
+  ej_t *h = &e->history;
+  if (h->done == h->num)
+    return ee_range;
+
+  long group = h->edits[h->done].group;
+  *where = e->size;
+  while (h->done < h->num && h->edits[h->done].group == group) {
+    eu_t *u = &h->edits[h->done++];
+    u->pieces = e_replace(e, u->where, u->oldsize, u->pieces, u->newsize);
+    *where = u->where < *where ? u->where : *where;
+  }
+  return ee_ok;
+}
+
+ee_t e_read(et_t *e, void *out, long where, long size, long *read) {
+  assert(e != NULL);
+  assert(out != NULL || size == 0);
+  assert(read != NULL);
+  *read = 0;
+
+  if (where < 0 || size < 0)
+    return ee_range;
+
+  if (where + size > e->size)
+    size = e->size > where ? e->size - where : 0;
+
+  ee_t err = e_readnode(e, e->root, 0, out, where, size);
+  if (err == ee_ok)
+    *read = size;
+  return err;
+}
+
+ee_t e_stream(et_t *e, stream_t *out) {
+  assert(e != NULL);
+  assert(out != NULL);
+
+  cookie_io_functions_t io = {.read = e_cookieread, .seek = e_cookieseek};
+  FILE *handle = fopencookie(e, "rb", io);
+  if (s_openhandle(out, handle, sm_binary_read) != se_ok)
+    return ee_stream;
+  return ee_ok;
+}
+
+ee_t e_save(et_t *e, cstr path, es_t *out) {
+  assert(e != NULL);
+  assert(path != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (e->original->type != st_file || fileno(e->original->handle) < 0)
+    return ee_stream;
+
+  el_t list = {0};
+  long pos = 0;
+  e_collect(e->root, &pos, &list);
+
+  ee_t err;
+  out->inplace = e_inplace(e, &list);
+  if (out->inplace)
+    err = e_saveinplace(e, &list, path, out);
+  else
+    err = e_saverename(e, &list, path, out);
+
+  free(list.items);
+  errno = 0;
+  return err;
+}
+
+ee_t e_journal(et_t *e, cstr path) {
+  assert(e != NULL);
+  assert(path != NULL);
+
+  el_t list = {0};
+  long pos = 0;
+  e_collect(e->root, &pos, &list);
+
+  ee_t err = e_inplace(e, &list) ? e_writejournal(e, &list, path) : ee_range;
+  free(list.items);
+  return err;
+}
+
+ee_t e_recover(cstr path, long *replayed) {
+  assert(path != NULL);
+  assert(replayed != NULL);
+  *replayed = 0;
+
+  // a new file not renamed yet: the original is intact
+  char side[PATH_MAX];
+  e_sidepath(path, "hxtmp", side);
+  unlink(side);
+
+  e_sidepath(path, "hxj", side);
+  int fd = open(side, O_RDONLY);
+  if (fd < 0) {
+    errno = 0;
+    return ee_ok;
+  }
+
+  struct stat st;
+  long bytes = fstat(fd, &st) == 0 ? st.st_size : 0;
+  uint8_t *buf = malloc(bytes + 1);
+  assert(buf != NULL);
+  long got = bytes > 0 ? pread(fd, buf, bytes, 0) : 0;
+  close(fd);
+
+  // a torn journal was being written: the file was not touched yet
+  int valid = got == bytes && bytes >= 24 && memcmp(buf, "HXJ1", 4) == 0;
+  if (valid) {
+    dc_t c;
+    dd_t d;
+    d_init(&c, dk_xxh3);
+    d_update(&c, buf + 16, bytes - 16);
+    d_final(&c, &d);
+    valid = memcmp(buf + 8, d.bytes, 8) == 0;
+  }
+
+  ee_t err = ee_ok;
+  int out = valid ? open(path, O_WRONLY) : -1;
+  if (valid && out < 0)
+    err = ee_write;
+
+  uint64_t spans = 0;
+  if (out >= 0)
+    memcpy(&spans, buf + 16, 8);
+
+  long at = 24;
+  for (uint64_t i = 0; i < spans && err == ee_ok; i++) {
+    uint64_t span[2];
+    memcpy(span, buf + at, 16);
+    if (at + 16 + (long)span[1] > bytes)
+      break;
+    if (pwrite(out, buf + at + 16, span[1], span[0]) != (ssize_t)span[1])
+      err = ee_write;
+    *replayed += span[1];
+    at += 16 + span[1];
+  }
+
+  if (out >= 0) {
+    if (err == ee_ok && fsync(out) != 0)
+      err = ee_write;
+    close(out);
+  }
+
+  if (err == ee_ok) {
+    unlink(side);
+    e_syncdir(path);
+  }
+
+  free(buf);
+  errno = 0;
+  return err;
+}
+
+ee_t e_export(et_t *e, cstr path, long *size) {
+  assert(e != NULL);
+  assert(path != NULL);
+  assert(size != NULL);
+  *size = 0;
+
+  el_t list = {0};
+  long pos = 0;
+  e_collect(e->root, &pos, &list);
+
+  ex_t x = {.edit = e, .file = fopen(path, "wb"), .buf = malloc(1 << 20)};
+  assert(x.buf != NULL);
+  if (x.file == NULL)
+    x.err = ee_write;
+  d_init(&x.patch, dk_xxh3);
+  d_init(&x.source, dk_xxh3);
+  d_init(&x.target, dk_xxh3);
+
+  uint64_t sizes[2] = {e->original->size, e->size};
+  e_put(&x, "HXP1", 4);
+  e_put(&x, sizes, 16);
+
+  // the source is read once, in order: original pieces never move back
+  er_t r = {0};
+  long src = 0;
+  for (long i = 0; i < list.num && x.err == ee_ok; i++) {
+    ep_t *p = list.items[i].piece;
+    if (!p->added && p->offset >= src) {
+      e_original(&x, src, p->offset - src, &x.source, NULL, 0);
+      r.skip += p->offset - src;
+      if (r.skip > 0 || r.size > 0)
+        e_flush(&x, &list, &r);
+
+      e_original(&x, p->offset, p->size, &x.source, &x.target, 0);
+      r.copy += p->size;
+      src = p->offset + p->size;
+      continue;
+    }
+
+    if (r.size == 0)
+      r.first = i;
+    r.last = i + 1;
+    r.size += p->size;
+    if (p->added)
+      d_update(&x.target, e->added + p->offset, p->size);
+    else
+      e_original(&x, p->offset, p->size, NULL, &x.target, 0);
+  }
+
+  e_original(&x, src, e->original->size - src, &x.source, NULL, 0);
+  r.skip += e->original->size - src;
+  e_flush(&x, &list, &r);
+
+  dd_t d[3];
+  d_final(&x.source, &d[0]);
+  d_final(&x.target, &d[1]);
+  e_put(&x, d[0].bytes, 8);
+  e_put(&x, d[1].bytes, 8);
+  d_final(&x.patch, &d[2]);
+  if (x.err == ee_ok && fwrite(d[2].bytes, 1, 8, x.file) != 8)
+    x.err = ee_write;
+
+  if (x.file != NULL) {
+    *size = ftell(x.file);
+    if (fclose(x.file) != 0 && x.err == ee_ok)
+      x.err = ee_write;
+  }
+  if (x.err != ee_ok)
+    unlink(path);
+
+  free(x.buf);
+  free(list.items);
+  errno = 0;
+  return x.err;
+}
+
+ee_t e_apply(cstr patch, cstr path, long *size) {
+  assert(patch != NULL);
+  assert(path != NULL);
+  assert(size != NULL);
+  *size = 0;
+
+  ex_t x = {.file = fopen(patch, "rb"), .buf = malloc(1 << 20)};
+  assert(x.buf != NULL);
+  if (x.file == NULL) {
+    free(x.buf);
+    errno = 0;
+    return ee_read;
+  }
+  d_init(&x.patch, dk_xxh3);
+  d_init(&x.source, dk_xxh3);
+  d_init(&x.target, dk_xxh3);
+
+  char magic[4];
+  uint64_t sizes[2] = {0};
+  if (e_get(&x, magic, 4) && memcmp(magic, "HXP1", 4) != 0)
+    x.err = ee_patch;
+  e_get(&x, sizes, 16);
+
+  int in = open(path, O_RDONLY);
+  struct stat st;
+  if (x.err == ee_ok && (in < 0 || fstat(in, &st) != 0))
+    x.err = ee_read;
+  else if (x.err == ee_ok && (uint64_t)st.st_size != sizes[0])
+    x.err = ee_source;
+
+  char tmp[PATH_MAX];
+  e_sidepath(path, "hxtmp", tmp);
+  FILE *out = NULL;
+  if (x.err == ee_ok) {
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, st.st_mode & 0777);
+    out = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (out == NULL)
+      x.err = ee_write;
+  }
+
+  // records until both sides are complete, each one making progress
+  long source = sizes[0], target = sizes[1], src = 0, dst = 0;
+  while (x.err == ee_ok && (src < source || dst < target)) {
+    long copy = e_getvarint(&x);
+    long skip = e_getvarint(&x);
+    long add = e_getvarint(&x);
+    if (x.err != ee_ok || copy < 0 || skip < 0 || add < 0 ||
+        copy > source - src || skip > source - src - copy ||
+        add > target - dst - copy || copy + skip + add == 0) {
+      x.err = x.err != ee_ok ? x.err : ee_patch;
+      break;
+    }
+
+    e_pass(&x, in, copy, out, 1);
+    e_pass(&x, in, skip, out, 0);
+    e_literal(&x, add, out);
+    src += copy + skip;
+    dst += copy + add;
+  }
+
+  uint8_t footer[24];
+  dd_t d[3];
+  d_final(&x.source, &d[0]);
+  d_final(&x.target, &d[1]);
+  if (x.err == ee_ok && e_get(&x, footer, 16)) {
+    d_final(&x.patch, &d[2]);
+    if (fread(footer + 16, 1, 8, x.file) != 8 || fgetc(x.file) != EOF ||
+        memcmp(footer + 16, d[2].bytes, 8) != 0 ||
+        memcmp(footer + 8, d[1].bytes, 8) != 0)
+      x.err = ee_patch;
+    else if (memcmp(footer, d[0].bytes, 8) != 0)
+      x.err = ee_source;
+  }
+
+  // the new file is complete and durable before it replaces the old one
+  if (out != NULL) {
+    if (x.err == ee_ok && (fflush(out) != 0 || fsync(fileno(out)) != 0))
+      x.err = ee_write;
+    fclose(out);
+    if (x.err == ee_ok && rename(tmp, path) != 0)
+      x.err = ee_write;
+    if (x.err != ee_ok)
+      unlink(tmp);
+    e_syncdir(path);
+  }
+
+  if (in >= 0)
+    close(in);
+  fclose(x.file);
+  free(x.buf);
+  *size = x.err == ee_ok ? target : 0;
+  errno = 0;
+  return x.err;
+}
+
+void e_free(et_t *e) {
+  assert(e != NULL);
+  e_freenode(e->root);
+  for (long i = 0; i < e->history.num; i++)
+    e_freenode(e->history.edits[i].pieces);
+  free(e->added);
+  free(e->history.edits);
+  memset(e, 0, sizeof(*e));
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "digest.h"
+#include "stream.h"
+#include "typedef.h"
+
+/*******************************************************************************
+ *                          Edit object definitions
+ *******************************************************************************/
+
+/*
+ * Edit error codes
+ */
+typedef enum {
+  ee_ok,
+  ee_read,
+  ee_range,
+  ee_stream,
+  ee_write,
+  ee_patch,
+  ee_source
+} ee_t;
+
+/*
+ * Piece of the edited content: `size` bytes from `offset` of the original
+ * stream or of the added bytes. Pieces are the nodes of a treap ordered by
+ * position, `total` being the size of the subtree and `count` its pieces.
+ */
+typedef struct ep_s {
+  struct ep_s *left;
+  struct ep_s *right;
+  long offset;
+  long size;
+  long total;
+  long count;
+  uint32_t priority;
+  int added;
+} ep_t;
+
+/*
+ * Edit that can be undone: `oldsize` bytes at `where` became `newsize` bytes.
+ * It keeps the pieces out of the content, the ones it removed while applied
+ * and the ones it added while undone, so that no byte is ever copied. The
+ * edits of a group, numbered from 1, are undone and redone together.
+ */
+typedef struct {
+  long where;
+  long oldsize;
+  long newsize;
+  ep_t *pieces;
+  long group;
+} eu_t;
+
+/*
+ * History of edits, the first `done` of them applied. `open` groups are begun
+ * and not ended yet.
+ */
+typedef struct {
+  eu_t *edits;
+  long num;
+  long alloc;
+  long done;
+  long open;
+  int joining;
+} ej_t;
+
+/*
+ * Edited content of a stream, which is never written
+ */
+typedef struct {
+  stream_t *original;
+  ep_t *root;
+  uint8_t *added;
+  long addsize;
+  long addalloc;
+  long size;
+  long pieces;
+  long cursor;
+  uint64_t seed;
+  ej_t history;
+} et_t;
+
+/*
+ * What a save did: overwrite in place, or write a new file copying the
+ * unchanged bytes
+ */
+typedef struct {
+  int inplace;
+  long written;
+  long copied;
+} es_t;
+
+/*******************************************************************************
+ *                            Edit functions
+ *******************************************************************************/
+
+/*
+ * Start editing `original`, which must outlive the edits
+ */
+ee_t e_init(et_t *out, stream_t *original);
+
+/*
+ * Replace `size` bytes at `where` by `data`
+ */
+ee_t e_overwrite(et_t *e, long where, const void *data, long size);
+
+/*
+ * Insert `size` bytes at `where`, which may be the end
+ */
+ee_t e_insert(et_t *e, long where, const void *data, long size);
+
+/*
+ * Remove `size` bytes at `where`
+ */
+ee_t e_delete(et_t *e, long where, long size);
+
+/*
+ * Replace `oldsize` bytes at `where` by `newsize` bytes, as one edit
+ */
+ee_t e_splice(et_t *e, long where, long oldsize, const void *data,
+              long newsize);
+
+/*
+ * Replace every occurrence of `fsize` bytes by `rsize` bytes in `size` bytes
+ * from `where`, without overlaps, as one edit. The content is read in blocks
+ * and a run of close matches is one splice, so memory grows with the runs,
+ * not with the matches. Get how many were replaced.
+ */
+ee_t e_replaceall(et_t *e, long where, long size, const void *find,
+                  long fsize, const void *with, long rsize, long *count);
+
+/*
+ * Make the edits up to e_end one for undo and redo. Groups may be nested.
+ */
+void e_begin(et_t *e);
+
+/*
+ * End the group of edits of the last e_begin
+ */
+void e_end(et_t *e);
+
+/*
+ * Undo the last edit (or group) applied and get where it was, ee_range if
+ * none is left
+ */
+ee_t e_undo(et_t *e, long *where);
+
+/*
+ * Apply again the last edit (or group) undone, ee_range if none is left. A
+ * new edit drops the edits undone.
+ */
+ee_t e_redo(et_t *e, long *where);
+
+/*
+ * Read the edited content at `where`
+ */
+ee_t e_read(et_t *e, void *out, long where, long size, long *read);
+
+/*
+ * Open a read-only stream of the edited content. Its size must be set again
+ * after every edit.
+ */
+ee_t e_stream(et_t *e, stream_t *out);
+
+/*
+ * Write the edits to `path`, the file of the original stream. When no byte
+ * moved, the edited spans are written in place after a journal; else a new
+ * file is written aside and renamed over `path`.
+ */
+ee_t e_save(et_t *e, cstr path, es_t *out);
+
+/*
+ * Write and sync the journal of an in-place save of `path` (`path`.hxj)
+ */
+ee_t e_journal(et_t *e, cstr path);
+
+/*
+ * Finish a save of `path` cut short: replay a complete journal, drop a torn
+ * one or a partial new file. Get how many bytes were written again.
+ */
+ee_t e_recover(cstr path, long *replayed);
+
+/*
+ * Write the edits to `path` as a patch of the original stream: records that
+ * keep, drop or add bytes, checked by the xxh3 of the source, of the target
+ * and of the patch itself. Get the size of the patch.
+ */
+ee_t e_export(et_t *e, cstr path, long *size);
+
+/*
+ * Apply a patch to the file at `path` reading both once, in constant memory.
+ * The result is written aside and renamed over `path` once checked:
+ * ee_source if the patch is for another file, ee_patch if it is damaged. Get
+ * the new size.
+ */
+ee_t e_apply(cstr patch, cstr path, long *size);
+
+/*
+ * Free the edits, not the original stream
+ */
+void e_free(et_t *e);
@@ -0,0 +1,522 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "../edit.h"
+#include "../test.h"
+
+/*******************************************************************************
+ *                            Test data
+ *******************************************************************************/
+
+cstr e_path = "edit.bin";
+
+/*******************************************************************************
+ *                       Test utility functions
+ *******************************************************************************/
+
+void e_util_write(long len) {
+  FILE *file = fopen(e_path, "w");
+  for (long i = 0; i < len; i++) {
+    fputc(i * 7, file);
+  }
+  fclose(file);
+}
+
+long e_util_read(uint8_t *out, long size) {
+  FILE *file = fopen(e_path, "r");
+  long read = fread(out, 1, size, file);
+  fclose(file);
+  return read;
+}
+
+/*******************************************************************************
+ *                           Test cases
+ *******************************************************************************/
+
+void e_test_edits(void) {
+  // arrange
+  e_util_write(100);
+  stream_t stream;
+  et_t e;
+  uint8_t out[100];
+  long read;
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+
+  // act
+  ee_t error = e_overwrite(&e, 10, "AB", 2);
+  ee_t range = e_overwrite(&e, 99, "AB", 2);
+  e_insert(&e, 0, "xyz", 3);
+  e_delete(&e, 50, 20);
+  e_insert(&e, 83, "end", 3);
+  e_read(&e, out, 0, sizeof(out), &read);
+
+  // assert
+  s_close(&stream);
+  remove(e_path);
+  t_exp("%i", ee_ok, "%i", error, { e_free(&e); });
+  t_exp("%i", ee_range, "%i", range, { e_free(&e); });
+  t_exp("%li", 86L, "%li", e.size, { e_free(&e); });
+  t_exp("%li", 86L, "%li", read, { e_free(&e); });
+  t_exp("%i", 0, "%i", memcmp(out, "xyz", 3), { e_free(&e); });
+  t_exp("%i", 9 * 7, "%i", out[12], { e_free(&e); });
+  t_exp("%i", 0, "%i", memcmp(out + 13, "AB", 2), { e_free(&e); });
+  t_exp("%i", (uint8_t)(67 * 7), "%i", out[50], { e_free(&e); });
+  t_exp("%i", 0, "%i", memcmp(out + 83, "end", 3), { e_free(&e); });
+  e_free(&e);
+  t_ok();
+}
+
+void e_test_random(void) {
+  // arrange
+  long len = 1 << 16;
+  e_util_write(len);
+  uint8_t *model = malloc(4 * len);
+  uint8_t *out = malloc(4 * len);
+  for (long i = 0; i < len; i++) {
+    model[i] = i * 7;
+  }
+
+  stream_t stream;
+  et_t e;
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+  uint64_t seed = 1;
+  long size = len;
+
+  // act
+  for (int i = 0; i < 2000; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    long where = (seed >> 20) % (size + 1);
+    long n = (seed >> 8) % 64;
+    uint8_t data[64];
+    memset(data, i, sizeof(data));
+
+    if (i % 3 == 0 && size + n < 4 * len) {
+      e_insert(&e, where, data, n);
+      memmove(model + where + n, model + where, size - where);
+      memcpy(model + where, data, n);
+      size += n;
+    } else if (i % 3 == 1 && where + n <= size) {
+      e_delete(&e, where, n);
+      memmove(model + where, model + where + n, size - where - n);
+      size -= n;
+    } else if (where + n <= size) {
+      e_overwrite(&e, where, data, n);
+      memcpy(model + where, data, n);
+    }
+  }
+
+  long read;
+  e_read(&e, out, 0, 4 * len, &read);
+
+  // assert
+  s_close(&stream);
+  remove(e_path);
+  int same = memcmp(out, model, size);
+  free(model);
+  free(out);
+  t_exp("%li", size, "%li", e.size, { e_free(&e); });
+  t_exp("%li", size, "%li", read, { e_free(&e); });
+  t_exp("%i", 0, "%i", same, { e_free(&e); });
+  e_free(&e);
+  t_ok();
+}
+
+void e_test_stream(void) {
+  // arrange
+  e_util_write(1000);
+  stream_t stream, edited, needle;
+  et_t e;
+  uint8_t out[8];
+  long read, which;
+  sb_t mem = {.data = out, .size = sizeof(out)};
+  sb_t pattern = {.data = "needle", .size = 6};
+  s_openfile(&stream, e_path, sm_read);
+  s_openmem(&needle, &pattern, sm_read);
+  e_init(&e, &stream);
+  e_insert(&e, 500, "needle", 6);
+  e_stream(&e, &edited);
+
+  // act
+  se_t error = s_readat(&edited, &mem, 503, &read);
+  se_t found = s_seek(&edited, &needle, 1, &which, edited.size);
+  long pos, size = edited.size;
+  s_pos(&edited, &pos);
+
+  // assert
+  s_close(&needle);
+  s_close(&edited);
+  s_close(&stream);
+  remove(e_path);
+  e_free(&e);
+  t_exp("%i", se_ok, "%i", error, {});
+  t_exp("%li", 8L, "%li", read, {});
+  t_exp("%i", 0, "%i", memcmp(out, "dle", 3), {});
+  t_exp("%i", (uint8_t)(500 * 7), "%i", out[3], {});
+  t_exp("%li", 1006L, "%li", size, {});
+  t_exp("%i", se_ok, "%i", found, {});
+  t_exp("%li", 506L, "%li", pos, {});
+  t_ok();
+}
+
+void e_test_save_inplace(void) {
+  // arrange
+  e_util_write(5000);
+  stream_t stream;
+  et_t e;
+  es_t saved;
+  uint8_t out[6000];
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+  e_overwrite(&e, 10, "AB", 2);
+  e_overwrite(&e, 12, "CD", 2);
+  e_insert(&e, 4000, "xy", 2);
+  e_delete(&e, 4000, 2);
+
+  // act
+  ee_t error = e_save(&e, e_path, &saved);
+  long read = e_util_read(out, sizeof(out));
+  int journal = access("edit.bin.hxj", F_OK);
+
+  // assert
+  s_close(&stream);
+  remove(e_path);
+  e_free(&e);
+  t_exp("%i", ee_ok, "%i", error, {});
+  t_exp("%i", 1, "%i", saved.inplace, {});
+  t_exp("%li", 4L, "%li", saved.written, {});
+  t_exp("%li", 5000L, "%li", read, {});
+  t_exp("%i", 0, "%i", memcmp(out + 10, "ABCD", 4), {});
+  t_exp("%i", (uint8_t)(14 * 7), "%i", out[14], {});
+  t_exp("%i", -1, "%i", journal, {});
+  t_ok();
+}
+
+void e_test_save_rename(void) {
+  // arrange
+  e_util_write(5000);
+  stream_t stream;
+  et_t e;
+  es_t saved;
+  uint8_t out[6000];
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+  e_insert(&e, 100, "new", 3);
+  e_delete(&e, 2000, 1000);
+
+  // act
+  ee_t error = e_save(&e, e_path, &saved);
+  long read = e_util_read(out, sizeof(out));
+
+  // assert
+  s_close(&stream);
+  remove(e_path);
+  e_free(&e);
+  t_exp("%i", ee_ok, "%i", error, {});
+  t_exp("%i", 0, "%i", saved.inplace, {});
+  t_exp("%li", 3L, "%li", saved.written, {});
+  t_exp("%li", 4000L, "%li", saved.copied, {});
+  t_exp("%li", 4003L, "%li", read, {});
+  t_exp("%i", 0, "%i", memcmp(out + 100, "new", 3), {});
+  t_exp("%i", (uint8_t)(2997 * 7), "%i", out[2000], {});
+  t_ok();
+}
+
+void e_test_recover(void) {
+  // arrange
+  e_util_write(5000);
+  stream_t stream;
+  et_t e;
+  uint8_t out[5000];
+  long replayed, torn;
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+  e_overwrite(&e, 4990, "0123456789", 10);
+  e_insert(&e, 0, "x", 1);
+  ee_t moved = e_journal(&e, e_path);
+  e_delete(&e, 0, 1);
+
+  // act
+  ee_t journal = e_journal(&e, e_path);
+  ee_t error = e_recover(e_path, &replayed);
+  e_util_read(out, sizeof(out));
+  int same = memcmp(out + 4990, "0123456789", 10);
+
+  e_overwrite(&e, 0, "zz", 2);
+  e_journal(&e, e_path);
+  truncate("edit.bin.hxj", 30);
+  e_recover(e_path, &torn);
+  e_util_read(out, sizeof(out));
+
+  // assert
+  s_close(&stream);
+  remove(e_path);
+  e_free(&e);
+  t_exp("%i", ee_range, "%i", moved, {});
+  t_exp("%i", ee_ok, "%i", journal, {});
+  t_exp("%i", ee_ok, "%i", error, {});
+  t_exp("%li", 10L, "%li", replayed, {});
+  t_exp("%i", 0, "%i", same, {});
+  t_exp("%li", 0L, "%li", torn, {});
+  t_exp("%i", 0, "%i", out[0], {});
+  t_exp("%i", -1, "%i", access("edit.bin.hxj", F_OK), {});
+  t_ok();
+}
+
+void e_test_undo(void) {
+  // arrange
+  long len = 200000;
+  e_util_write(len);
+  uint8_t *original = malloc(len);
+  uint8_t *edited = malloc(len);
+  uint8_t *out = malloc(len + 10);
+  uint8_t *zeros = calloc(100000, 1);
+  stream_t stream;
+  et_t e;
+  long where, read;
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+  e_read(&e, original, 0, len, &read);
+
+  e_overwrite(&e, 1000, zeros, 100000);
+  e_insert(&e, 5, "abc", 3);
+  e_delete(&e, 1003, 100000);
+  long added = e.addsize;
+  e_read(&e, edited, 0, len, &read);
+  long size = e.size;
+
+  // act
+  for (int i = 0; i < 3; i++) {
+    e_undo(&e, &where);
+  }
+  ee_t none = e_undo(&e, &where);
+  e_read(&e, out, 0, len + 10, &read);
+  int undone = read == len && memcmp(out, original, len) == 0;
+
+  for (int i = 0; i < 3; i++) {
+    e_redo(&e, &where);
+  }
+  e_read(&e, out, 0, len + 10, &read);
+  int redone = read == size && memcmp(out, edited, size) == 0;
+  long readded = e.addsize;
+
+  e_undo(&e, &where);
+  e_overwrite(&e, 0, "z", 1);
+  ee_t dropped = e_redo(&e, &where);
+
+  // assert
+  s_close(&stream);
+  remove(e_path);
+  free(original);
+  free(edited);
+  free(out);
+  free(zeros);
+  t_exp("%i", ee_range, "%i", none, { e_free(&e); });
+  t_exp("%i", 1, "%i", undone, { e_free(&e); });
+  t_exp("%i", 1, "%i", redone, { e_free(&e); });
+  t_exp("%i", ee_range, "%i", dropped, { e_free(&e); });
+  t_exp("%li", 1003L, "%li", where, { e_free(&e); });
+  t_exp("%li", added, "%li", readded, { e_free(&e); });
+  e_free(&e);
+  t_ok();
+}
+
+void e_test_undo_group(void) {
+  // arrange
+  e_util_write(5000);
+  stream_t stream;
+  et_t e;
+  long where, read;
+  uint8_t original[10], out[10];
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+  e_read(&e, original, 0, 10, &read);
+  e_overwrite(&e, 0, "a", 1);
+  e_begin(&e);
+  e_overwrite(&e, 8, "b", 1);
+  e_insert(&e, 4, "cd", 2);
+  e_end(&e);
+
+  // act
+  e_undo(&e, &where);
+  long grouped = e.history.done;
+  e_undo(&e, &where);
+  e_read(&e, out, 0, 10, &read);
+  e_redo(&e, &where);
+  e_redo(&e, &where);
+  long redone = e.history.done;
+
+  // assert
+  s_close(&stream);
+  remove(e_path);
+  long size = e.size;
+  e_free(&e);
+  t_exp("%li", 1L, "%li", grouped, {});
+  t_exp("%i", 0, "%i", memcmp(out, original, 10), {});
+  t_exp("%li", 3L, "%li", redone, {});
+  t_exp("%li", 4L, "%li", where, {});
+  t_exp("%li", 5002L, "%li", size, {});
+  t_ok();
+}
+
+void e_test_undo_save(void) {
+  // arrange
+  e_util_write(5000);
+  stream_t stream;
+  et_t e;
+  es_t saved;
+  long where;
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+  e_delete(&e, 0, 5000);
+  e_undo(&e, &where);
+
+  // act
+  ee_t error = e_save(&e, e_path, &saved);
+
+  // assert: the original pieces are back, nothing to write
+  s_close(&stream);
+  remove(e_path);
+  e_free(&e);
+  t_exp("%i", ee_ok, "%i", error, {});
+  t_exp("%i", 1, "%i", saved.inplace, {});
+  t_exp("%li", 0L, "%li", saved.written, {});
+  t_ok();
+}
+
+void e_test_replaceall(void) {
+  // arrange: 0, 7, 14... so that {249, 0, 7} is at 255 + 256 k, but for the
+  // last one cut by the end, one straddling the first block of 1 MiB
+  long len = 3L << 20;
+  e_util_write(len);
+  stream_t stream;
+  et_t e;
+  long count, read;
+  uint8_t find[] = {249, 0, 7};
+  uint8_t *out = malloc(len);
+  uint8_t *exp = malloc(len);
+  long size = 0;
+  for (long i = 0; i < len; i++) {
+    if (i % 256 == 255 && i + 3 <= len) {
+      memcpy(exp + size, "xy", 2);
+      size += 2;
+      i += 2;
+    } else {
+      exp[size++] = i * 7;
+    }
+  }
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+
+  // act
+  ee_t error = e_replaceall(&e, 0, len, find, 3, "xy", 2, &count);
+  e_read(&e, out, 0, len, &read);
+  int same = read == size && memcmp(out, exp, size) == 0;
+  long where;
+  e_undo(&e, &where);
+  long undone = e.size;
+
+  // assert
+  s_close(&stream);
+  remove(e_path);
+  e_free(&e);
+  free(out);
+  free(exp);
+  t_exp("%i", ee_ok, "%i", error, {});
+  t_exp("%li", len / 256 - 1, "%li", count, {});
+  t_exp("%i", 1, "%i", same, {});
+  t_exp("%li", len, "%li", undone, {});
+  t_ok();
+}
+
+void e_test_replaceall_dense(void) {
+  // arrange
+  long len = (2L << 20) + 5;
+  FILE *file = fopen(e_path, "w");
+  for (long i = 0; i < len; i++)
+    fputc(0x42, file);
+  fclose(file);
+  stream_t stream;
+  et_t e;
+  long count, read;
+  uint8_t out[16];
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+
+  // act
+  ee_t error = e_replaceall(&e, 0, len, "\x42", 1, "\x43", 1, &count);
+  e_read(&e, out, len - 16, 16, &read);
+  long edits = e.history.num;
+  long pieces = e.pieces;
+  long added = e.addsize;
+
+  // assert: one splice per block, not per match
+  s_close(&stream);
+  remove(e_path);
+  e_free(&e);
+  t_exp("%i", ee_ok, "%i", error, {});
+  t_exp("%li", len, "%li", count, {});
+  t_exp("%i", 0x43, "%i", out[15], {});
+  t_exp("%li", 3L, "%li", edits, {});
+  t_exp("%li", 3L, "%li", pieces, {});
+  t_exp("%li", len, "%li", added, {});
+  t_ok();
+}
+
+void e_test_patch(void) {
+  // arrange
+  long len = 3 * (1 << 20);
+  e_util_write(len);
+  uint8_t *edited = malloc(len);
+  uint8_t *out = malloc(len);
+  stream_t stream;
+  et_t e;
+  long read, size, applied, again;
+  s_openfile(&stream, e_path, sm_read);
+  e_init(&e, &stream);
+  e_overwrite(&e, 10, "AB", 2);
+  e_insert(&e, 1 << 20, "inserted", 8);
+  e_delete(&e, 2 << 20, 5000);
+  e_overwrite(&e, e.size - 3, "end", 3);
+  e_read(&e, edited, 0, e.size, &read);
+
+  // act
+  ee_t error = e_export(&e, "edit.hxp", &size);
+  s_close(&stream);
+  ee_t apply = e_apply("edit.hxp", e_path, &applied);
+  ee_t other = e_apply("edit.hxp", e_path, &again);
+  read = e_util_read(out, len);
+
+  // assert
+  remove(e_path);
+  remove("edit.hxp");
+  t_exp("%i", ee_ok, "%i", error, { e_free(&e); });
+  t_exp("%i", 1, "%i", (size > 13 && size < 100), { e_free(&e); });
+  t_exp("%i", ee_ok, "%i", apply, { e_free(&e); });
+  t_exp("%i", ee_source, "%i", other, { e_free(&e); });
+  t_exp("%li", e.size, "%li", applied, { e_free(&e); });
+  t_exp("%li", e.size, "%li", read, { e_free(&e); });
+  t_exp("%i", 0, "%i", memcmp(out, edited, read), { e_free(&e); });
+  free(edited);
+  free(out);
+  e_free(&e);
+  t_ok();
+}
+
+int main(int argc, char **argv) {
+  e_test_edits();
+  e_test_random();
+  e_test_stream();
+  e_test_save_inplace();
+  e_test_save_rename();
+  e_test_recover();
+  e_test_undo();
+  e_test_undo_group();
+  e_test_undo_save();
+  e_test_replaceall();
+  e_test_replaceall_dense();
+  e_test_patch();
+  return 0;
+}
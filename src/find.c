@@ -0,0 +1,677 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "find.h"
+
+/*******************************************************************************
+ *                       Internal utility functions
+ *******************************************************************************/
+
+static void f_push(fl_t *list, fr_t run) {
+  if (list->num >= list->alloc) {
+    list->alloc = list->alloc > 0 ? list->alloc * 2 : 256;
+    list->runs = realloc(list->runs, sizeof(fr_t) * list->alloc);
+    assert(list->runs != NULL);
+  }
+
+  list->runs[list->num++] = run;
+}
+
+static void f_pushhit(fk_t *list, fh_t hit) {
+  list->total++;
+  f_pushoffset(&list->offsets, hit.offset);
+  if (list->num < list->alloc)
+    list->hits[list->num++] = hit;
+}
+
+/*
+ * Report the encodings of `v` found at p[pos], if stream offset `base + pos`
+ * is aligned
+ */
+static void f_valcheck(const uint8_t *p, long pos, long base, fv_t *v,
+                       long align, fk_t *out) {
+  if ((base + pos) % align != 0)
+    return;
+
+  for (long k = 0; k < v->num; k++) {
+    if (memcmp(p + pos, v->bytes[k], v->width) == 0)
+      f_pushhit(out, (fh_t){base + pos, v->order[k]});
+  }
+}
+
+/*
+ * Find `v` at positions 0 to `n` - 1 of `p`, which holds `width` - 1 more
+ * bytes. `base` is the stream offset of p[0].
+ */
+static void f_valscan(const uint8_t *p, long n, long base, fv_t *v, long align,
+                      fk_t *out) {
+  long w = v->width;
+  long first = (align - base % align) % align;
+  long i = 0;
+
+  if (align > 16) {
+    // sparse offsets: the comparisons are cheaper than any filter
+    for (i = first; i < n; i += align)
+      f_valcheck(p, i, base, v, align, out);
+    return;
+  }
+
+  if (align % w == 0) {
+    // lanes of `width` bytes from an aligned offset: a hit is a lane whose
+    // bytes all match one encoding tiled over 16 bytes
+    static const uint32_t lanes[9] = {[2] = 0x5555, [4] = 0x1111,
+                                      [8] = 0x0101};
+    v16_t tile[2];
+    for (long k = 0; k < v->num; k++) {
+      for (long b = 0; b < 16; b++)
+        tile[k][b] = v->bytes[k][b % w];
+    }
+
+    for (i = first; i + 16 <= n + w - 1; i += 16) {
+      v16_t x = v_load(p + i);
+      for (long k = 0; k < v->num; k++) {
+        uint32_t same = ~v_mask(x ^ tile[k]) & 0xFFFF;
+        for (long shift = 1; shift < w; shift *= 2)
+          same &= same >> shift;
+        same &= lanes[w];
+
+        for (; same != 0; same &= same - 1) {
+          long pos = i + __builtin_ctz(same);
+          if ((base + pos) % align == 0)
+            f_pushhit(out, (fh_t){base + pos, v->order[k]});
+        }
+      }
+    }
+
+    for (; i < n; i += w)
+      f_valcheck(p, i, base, v, align, out);
+    return;
+  }
+
+  // any offset: candidates match the first 2 bytes of an encoding, 16
+  // positions at once, then are compared in full
+  v16_t first0[2], first1[2];
+  for (long k = 0; k < v->num; k++) {
+    first0[k] = v_splat(v->bytes[k][0]);
+    first1[k] = v_splat(v->bytes[k][1]);
+  }
+
+  for (; i + 16 <= n; i += 16) {
+    v16_t x0 = v_load(p + i);
+    v16_t x1 = v_load(p + i + 1);
+    uint32_t candidates = 0;
+    for (long k = 0; k < v->num; k++)
+      candidates |= ~(v_mask(x0 ^ first0[k]) | v_mask(x1 ^ first1[k]));
+    candidates &= 0xFFFF;
+
+    for (; candidates != 0; candidates &= candidates - 1)
+      f_valcheck(p, i + __builtin_ctz(candidates), base, v, align, out);
+  }
+
+  for (; i < n; i++)
+    f_valcheck(p, i, base, v, align, out);
+}
+
+/*
+ * Find the XOR differences `diff` at positions 0 to `n` - 1 of `p`, which
+ * holds the pattern size - 1 more bytes. `base` is the stream offset of p[0].
+ */
+static void f_xorscan(const uint8_t *p, long n, long base, const uint8_t *diff,
+                      long ndiff, const uint8_t *pattern, fq_t *out) {
+  long keylen = out->keylen;
+
+  // filter on 2 differences, not zero if possible: runs of one byte in the
+  // data have zero differences everywhere
+  long j0 = 0;
+  while (j0 + 1 < ndiff && diff[j0] == 0)
+    j0++;
+  long j1 = j0 + 1 < ndiff ? j0 + 1 : j0;
+  while (j1 + 1 < ndiff && diff[j1] == 0)
+    j1++;
+
+  v16_t d0 = v_splat(diff[j0]);
+  v16_t d1 = v_splat(diff[j1]);
+  long i = 0;
+
+  for (; i < n; i += 16) {
+    uint32_t candidates;
+    if (i + 16 <= n) {
+      v16_t x0 = v_load(p + i + j0) ^ v_load(p + i + j0 + keylen);
+      v16_t x1 = v_load(p + i + j1) ^ v_load(p + i + j1 + keylen);
+      candidates = ~(v_mask(x0 ^ d0) | v_mask(x1 ^ d1)) & 0xFFFF;
+    } else {
+      candidates = (1U << (n - i)) - 1;
+    }
+
+    for (; candidates != 0; candidates &= candidates - 1) {
+      long pos = i + __builtin_ctz(candidates);
+      long j = 0;
+      while (j < ndiff && (p[pos + j] ^ p[pos + j + keylen]) == diff[j])
+        j++;
+      if (j < ndiff)
+        continue;
+
+      fx_t hit = {.offset = base + pos};
+      for (long k = 0; k < keylen; k++)
+        hit.key[k] = p[pos + k] ^ pattern[k];
+
+      out->total++;
+      f_pushoffset(&out->offsets, hit.offset);
+      if (out->num < out->alloc)
+        out->hits[out->num++] = hit;
+    }
+  }
+}
+
+/*
+ * Bit pattern shifted right by 0 to 7 bits: the bytes it covers, with the
+ * bits of the pattern set in `mask`, and the byte of most set bits
+ */
+typedef struct {
+  uint8_t value[9];
+  uint8_t mask[9];
+  long bytes;
+  long best;
+} fw_t;
+
+static void f_shiftbits(uint64_t bits, long nbits, long shift, fw_t *out) {
+  memset(out, 0, sizeof(*out));
+  out->bytes = (shift + nbits + 7) / 8;
+
+  for (long b = 0; b < nbits; b++) {
+    long at = shift + b;
+    uint8_t one = 0x80 >> (at % 8);
+    out->mask[at / 8] |= one;
+    if (bits >> (nbits - 1 - b) & 1)
+      out->value[at / 8] |= one;
+  }
+
+  for (long b = 1; b < out->bytes; b++) {
+    if (__builtin_popcount(out->mask[b]) >
+        __builtin_popcount(out->mask[out->best]))
+      out->best = b;
+  }
+}
+
+/*
+ * Find the shifted patterns at positions 0 to `n` - 1 of `p`, which holds
+ * `avail` bytes. `base` is the stream offset of p[0].
+ */
+static void f_bitscan(const uint8_t *p, long n, long avail, long base,
+                      fw_t shifted[8], fs_t *out) {
+  v16_t value[8], mask[8];
+  for (long s = 0; s < 8; s++) {
+    value[s] = v_splat(shifted[s].value[shifted[s].best]);
+    mask[s] = v_splat(shifted[s].mask[shifted[s].best]);
+  }
+
+  for (long i = 0; i < n; i += 16) {
+    // every shift is filtered on its fullest byte, 16 positions at once
+    uint32_t candidates = 0;
+    if (i + 16 + 8 <= avail) {
+      for (long s = 0; s < 8; s++) {
+        v16_t x = v_load(p + i + shifted[s].best) & mask[s];
+        candidates |= ~v_mask(x ^ value[s]) & 0xFFFF;
+      }
+    } else {
+      candidates = 0xFFFF;
+    }
+
+    for (; candidates != 0; candidates &= candidates - 1) {
+      long pos = i + __builtin_ctz(candidates);
+      if (pos >= n)
+        break;
+
+      for (long s = 0; s < 8; s++) {
+        fw_t *w = &shifted[s];
+        long b = 0;
+        while (b < w->bytes && pos + b < avail &&
+               (p[pos + b] & w->mask[b]) == w->value[b])
+          b++;
+        if (b < w->bytes)
+          continue;
+
+        // an offset where several shifts match is listed once
+        fp_t *seen = &out->offsets;
+        if (seen->num == 0 || seen->offsets[seen->num - 1] != base + pos)
+          f_pushoffset(seen, base + pos);
+
+        out->total++;
+        if (out->num < out->alloc)
+          out->hits[out->num++] = (fb_t){base + pos, s};
+      }
+    }
+  }
+}
+
+/*
+ * Block read on a thread of its own
+ */
+typedef struct {
+  stream_t *stream;
+  uint8_t *buf;
+  long where;
+  long size;
+  fe_t err;
+} fd_t;
+
+static void *f_readblock(void *arg) {
+  fd_t *d = arg;
+  sb_t mem = {.data = d->buf, .size = d->size};
+  long read = 0;
+  if (s_readat(d->stream, &mem, d->where, &read) != se_ok || read != d->size)
+    d->err = fe_read;
+  return NULL;
+}
+
+/*
+ * Find the pattern at positions 0 to `n` - 1 of `p`, which holds `size` - 1
+ * more bytes, from stream offset `*next` on. `base` is the stream offset of
+ * p[0].
+ */
+static void f_allscan(const uint8_t *p, long n, long base,
+                      const uint8_t *pattern, long size, long *next,
+                      fp_t *out) {
+  v16_t first = v_splat(pattern[0]);
+  v16_t last = v_splat(pattern[size - 1]);
+  long i = *next > base ? *next - base : 0;
+
+  for (; i < n; i += 16) {
+    // candidates match the first and last bytes, 16 positions at once
+    uint32_t candidates = 0xFFFF;
+    if (i + 16 <= n) {
+      candidates = ~(v_mask(v_load(p + i) ^ first) |
+                     v_mask(v_load(p + i + size - 1) ^ last)) & 0xFFFF;
+    }
+
+    for (; candidates != 0; candidates &= candidates - 1) {
+      long pos = i + __builtin_ctz(candidates);
+      if (pos >= n || base + pos < *next)
+        continue;
+      if (memcmp(p + pos, pattern, size) != 0)
+        continue;
+
+      f_pushoffset(out, base + pos);
+      *next = base + pos + size;
+    }
+  }
+}
+
+/*******************************************************************************
+ *                            Find functions
+ *******************************************************************************/
+
+fe_t f_runs(stream_t *s, long off, long len, long minlen, fl_t *out) {
+  assert(s != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (minlen < 2)
+    return fe_size;
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return fe_range;
+
+  const long block = 1 << 20;
+  uint8_t *buf = malloc(block);
+  assert(buf != NULL);
+
+  // the current run may continue over the next block
+  fr_t run = {off, 0, 0};
+
+  for (long done = 0; done < len;) {
+    long n = len - done < block ? len - done : block;
+    sb_t mem = {.data = buf, .size = n};
+    long read = 0;
+
+    if (s_readat(s, &mem, off + done, &read) != se_ok || read != n) {
+      free(buf);
+      return fe_read;
+    }
+
+    for (long i = 0; i < n;) {
+      if (run.size == 0 || buf[i] != run.byte) {
+        if (run.size >= minlen)
+          f_push(out, run);
+
+        // bytes differing from the next one are runs of 1, up to 16 skipped
+        long single = 0;
+        if (i + 17 <= n) {
+          uint32_t differ = v_diffmask(buf + i, buf + i + 1);
+          single = __builtin_ctz(~differ);
+        }
+
+        i += single;
+        run = (fr_t){off + done + i, 0, buf[i]};
+      }
+
+      long same = v_run(buf + i, n - i, run.byte);
+      run.size += same;
+      i += same;
+    }
+
+    done += n;
+  }
+
+  if (run.size >= minlen)
+    f_push(out, run);
+
+  free(buf);
+  return fe_ok;
+}
+
+void f_free(fl_t *list) {
+  assert(list != NULL);
+  free(list->runs);
+  memset(list, 0, sizeof(*list));
+}
+
+fe_t f_value(cstr type, cstr value, fv_t *out) {
+  assert(type != NULL);
+  assert(value != NULL);
+  memset(out, 0, sizeof(*out));
+
+  const char *kinds = "uif";
+  char *kind = strchr(kinds, type[0]);
+  if (type[0] == '\0' || kind == NULL)
+    return fe_type;
+
+  char *end;
+  long bits = strtol(type + 1, &end, 10);
+  int big = strcmp(end, "be") == 0;
+  int little = strcmp(end, "le") == 0;
+  if (!big && !little && *end != '\0')
+    return fe_type;
+
+  int width = bits == 16 || bits == 32 || bits == 64;
+  if (!width || (*kind == 'f' && bits == 16))
+    return fe_type;
+
+  // the value as the host (little endian) lays it out
+  uint64_t raw = 0;
+  errno = 0;
+  if (*kind == 'f') {
+    double d = strtod(value, &end);
+    float f = d;
+    if (bits == 32)
+      memcpy(&raw, &f, sizeof(f));
+    else
+      memcpy(&raw, &d, sizeof(d));
+  } else if (*kind == 'i') {
+    long long i = strtoll(value, &end, 0);
+    long long max = bits == 64 ? INT64_MAX : (1LL << (bits - 1)) - 1;
+    if (i > max || i < -max - 1)
+      return fe_value;
+    raw = i;
+  } else {
+    unsigned long long u = strtoull(value, &end, 0);
+    unsigned long long max = bits == 64 ? UINT64_MAX : (1ULL << bits) - 1;
+    if (strchr(value, '-') != NULL || u > max)
+      return fe_value;
+    raw = u;
+  }
+
+  if (end == value || *end != '\0' || errno != 0)
+    return fe_value;
+
+  out->width = bits / 8;
+  for (long b = 0; b < out->width; b++) {
+    out->bytes[0][b] = raw >> (8 * b);
+    out->bytes[1][b] = raw >> (8 * (out->width - 1 - b));
+  }
+
+  out->num = 2;
+  out->order[0] = fo_little;
+  out->order[1] = fo_big;
+  if (memcmp(out->bytes[0], out->bytes[1], out->width) == 0) {
+    out->num = 1;
+    out->order[0] = big || little ? out->order[big] : fo_both;
+  } else if (big || little) {
+    memcpy(out->bytes[0], out->bytes[big], out->width);
+    out->num = 1;
+    out->order[0] = out->order[big];
+  }
+
+  return fe_ok;
+}
+
+fe_t f_findval(stream_t *s, long off, long len, fv_t *v, long align, long max,
+               long keep, fk_t *out) {
+  assert(s != NULL);
+  assert(v != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (align < 1 || max < 0 || keep < 0)
+    return fe_size;
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return fe_range;
+
+  out->alloc = max;
+  out->offsets.max = keep;
+  out->hits = malloc(sizeof(fh_t) * (max + 1));
+  assert(out->hits != NULL);
+
+  // blocks overlap by `width` - 1 bytes so that no value is cut
+  const long block = 1 << 20;
+  uint8_t *buf = malloc(block + v->width);
+  assert(buf != NULL);
+
+  for (long done = 0; done + v->width <= len; done += block) {
+    long n = len - done < block + v->width - 1 ? len - done
+                                               : block + v->width - 1;
+    sb_t mem = {.data = buf, .size = n};
+    long read = 0;
+
+    if (s_readat(s, &mem, off + done, &read) != se_ok || read != n) {
+      free(buf);
+      return fe_read;
+    }
+
+    f_valscan(buf, n - v->width + 1, off + done, v, align, out);
+  }
+
+  free(buf);
+  return fe_ok;
+}
+
+void f_freehits(fk_t *list) {
+  assert(list != NULL);
+  free(list->hits);
+  f_freeoffsets(&list->offsets);
+  memset(list, 0, sizeof(*list));
+}
+
+fe_t f_findxor(stream_t *s, long off, long len, const uint8_t *pattern,
+               long size, long keylen, long max, long keep, fq_t *out) {
+  assert(s != NULL);
+  assert(pattern != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (keylen < 1 || keylen > 8 || size <= keylen || max < 0 || keep < 0)
+    return fe_size;
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return fe_range;
+
+  out->alloc = max;
+  out->offsets.max = keep;
+  out->keylen = keylen;
+  out->hits = malloc(sizeof(fx_t) * (max + 1));
+  assert(out->hits != NULL);
+
+  // any key cancels out between bytes `keylen` apart: x[j] ^ x[j + keylen]
+  // is the same in the data as in the pattern, whatever the key
+  long ndiff = size - keylen;
+  uint8_t *diff = malloc(ndiff);
+  assert(diff != NULL);
+  for (long j = 0; j < ndiff; j++)
+    diff[j] = pattern[j] ^ pattern[j + keylen];
+
+  // blocks overlap by `size` - 1 bytes so that no match is cut
+  const long block = 1 << 20;
+  uint8_t *buf = malloc(block + size);
+  assert(buf != NULL);
+
+  fe_t err = fe_ok;
+  for (long done = 0; done + size <= len; done += block) {
+    long n = len - done < block + size - 1 ? len - done : block + size - 1;
+    sb_t mem = {.data = buf, .size = n};
+    long read = 0;
+
+    if (s_readat(s, &mem, off + done, &read) != se_ok || read != n) {
+      err = fe_read;
+      break;
+    }
+
+    f_xorscan(buf, n - size + 1, off + done, diff, ndiff, pattern, out);
+  }
+
+  free(buf);
+  free(diff);
+  return err;
+}
+
+void f_freexor(fq_t *list) {
+  assert(list != NULL);
+  free(list->hits);
+  f_freeoffsets(&list->offsets);
+  memset(list, 0, sizeof(*list));
+}
+
+fe_t f_findbits(stream_t *s, long off, long len, uint64_t bits, long nbits,
+                long max, long keep, fs_t *out) {
+  assert(s != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (nbits < 1 || nbits > 64 || max < 0 || keep < 0)
+    return fe_size;
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return fe_range;
+
+  out->alloc = max;
+  out->offsets.max = keep;
+  out->hits = malloc(sizeof(fb_t) * (max + 1));
+  assert(out->hits != NULL);
+
+  fw_t shifted[8];
+  for (long shift = 0; shift < 8; shift++)
+    f_shiftbits(bits, nbits, shift, &shifted[shift]);
+
+  // blocks overlap by 8 bytes, the most a shifted pattern spans beyond one
+  const long block = 1 << 20;
+  uint8_t *buf = malloc(block + 8);
+  assert(buf != NULL);
+
+  fe_t err = fe_ok;
+  for (long done = 0; done < len; done += block) {
+    long n = len - done < block ? len - done : block;
+    long avail = len - done < block + 8 ? len - done : block + 8;
+    sb_t mem = {.data = buf, .size = avail};
+    long read = 0;
+
+    if (s_readat(s, &mem, off + done, &read) != se_ok || read != avail) {
+      err = fe_read;
+      break;
+    }
+
+    f_bitscan(buf, n, avail, off + done, shifted, out);
+  }
+
+  free(buf);
+  return err;
+}
+
+void f_freebits(fs_t *list) {
+  assert(list != NULL);
+  free(list->hits);
+  f_freeoffsets(&list->offsets);
+  memset(list, 0, sizeof(*list));
+}
+
+fe_t f_findall(stream_t *s, long off, long len, const uint8_t *pattern,
+               long size, fp_t *out) {
+  assert(s != NULL);
+  assert(pattern != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (size < 1)
+    return fe_size;
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return fe_range;
+
+  // two buffers: one is searched while the next block is read in the other
+  const long block = 1 << 20;
+  uint8_t *bufs[2] = {malloc(block + size), malloc(block + size)};
+  assert(bufs[0] != NULL && bufs[1] != NULL);
+
+  long blocks = len >= size ? (len - size) / block + 1 : 0;
+  fd_t reads[2];
+  pthread_t reader;
+  long next = off;
+  fe_t err = fe_ok;
+
+  for (long b = 0; b < blocks; b++) {
+    // blocks overlap by `size` - 1 bytes so that no occurrence is cut
+    for (long k = b == 0 ? 0 : b + 1; k <= b + 1 && k < blocks; k++) {
+      long where = k * block;
+      long n = len - where < block + size - 1 ? len - where : block + size - 1;
+      reads[k % 2] = (fd_t){s, bufs[k % 2], off + where, n, fe_ok};
+      if (k == b)
+        f_readblock(&reads[k % 2]);
+      else
+        pthread_create(&reader, NULL, f_readblock, &reads[k % 2]);
+    }
+
+    fd_t *d = &reads[b % 2];
+    err = err == fe_ok ? d->err : err;
+    if (err == fe_ok)
+      f_allscan(d->buf, d->size - size + 1, d->where, pattern, size, &next,
+                out);
+    if (err == fe_ok && out->full)
+      err = fe_size;
+
+    if (b + 1 < blocks)
+      pthread_join(reader, NULL);
+  }
+
+  free(bufs[0]);
+  free(bufs[1]);
+  return err;
+}
+
+fe_t f_pushoffset(fp_t *list, long offset) {
+  assert(list != NULL);
+  if (list->max > 0 && list->num >= list->max) {
+    list->full = 1;
+    return fe_size;
+  }
+
+  if (list->num >= list->alloc) {
+    long alloc = list->alloc > 0 ? list->alloc * 2 : 256;
+    alloc = list->max > 0 && alloc > list->max ? list->max : alloc;
+    long *offsets = realloc(list->offsets, sizeof(long) * alloc);
+    if (offsets == NULL) {
+      list->full = 1;
+      return fe_size;
+    }
+    list->offsets = offsets;
+    list->alloc = alloc;
+  }
+
+  list->offsets[list->num++] = offset;
+  return fe_ok;
+}
+
+void f_freeoffsets(fp_t *list) {
+  assert(list != NULL);
+  free(list->offsets);
+  memset(list, 0, sizeof(*list));
+}
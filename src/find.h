@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stream.h"
+#include "typedef.h"
+#include "vector.h"
+
+/*******************************************************************************
+ *                          Find object definitions
+ *******************************************************************************/
+
+/*
+ * Find error codes
+ */
+typedef enum { fe_ok, fe_read, fe_range, fe_size, fe_type, fe_value } fe_t;
+
+/*
+ * Run of one repeated byte
+ */
+typedef struct {
+  long offset;
+  long size;
+  uint8_t byte;
+} fr_t;
+
+/*
+ * List of runs
+ */
+typedef struct {
+  fr_t *runs;
+  long num;
+  long alloc;
+} fl_t;
+
+/*
+ * Byte order of a value found, both when it reads the same either way
+ */
+typedef enum { fo_little, fo_big, fo_both } fo_t;
+
+/*
+ * Value to find: up to 2 encodings of `width` bytes, one per byte order
+ */
+typedef struct {
+  uint8_t bytes[2][8];
+  fo_t order[2];
+  long num;
+  long width;
+} fv_t;
+
+/*
+ * List of offsets, at most `max` of them unless `max` is 0. A list that had
+ * to refuse an offset is `full`.
+ */
+typedef struct {
+  long *offsets;
+  long num;
+  long alloc;
+  long max;
+  int full;
+} fp_t;
+
+/*
+ * Value found
+ */
+typedef struct {
+  long offset;
+  fo_t order;
+} fh_t;
+
+/*
+ * List of values found, the first `alloc` of `total`, with the
+ * offsets of the first `offsets.max` of all `total`
+ */
+typedef struct {
+  fh_t *hits;
+  long num;
+  long alloc;
+  long total;
+  fp_t offsets;
+} fk_t;
+
+/*
+ * Pattern found under a repeating XOR key, the key starting at `offset`
+ */
+typedef struct {
+  long offset;
+  uint8_t key[8];
+} fx_t;
+
+/*
+ * List of XOR patterns found, the first `alloc` of `total`, with the
+ * offsets of the first `offsets.max` of all `total`
+ */
+typedef struct {
+  fx_t *hits;
+  long num;
+  long alloc;
+  long total;
+  fp_t offsets;
+  long keylen;
+} fq_t;
+
+/*
+ * Bit pattern found at bit `bit` (0 is the most significant) of byte `offset`
+ */
+typedef struct {
+  long offset;
+  int bit;
+} fb_t;
+
+/*
+ * List of bit patterns found, the first `alloc` of `total`, with the
+ * first `offsets.max` offsets of all `total`, each once
+ */
+typedef struct {
+  fb_t *hits;
+  long num;
+  long alloc;
+  long total;
+  fp_t offsets;
+} fs_t;
+
+/*******************************************************************************
+ *                            Find functions
+ *******************************************************************************/
+
+/*
+ * Find every run of at least `minlen` (2 or more) identical bytes in `len`
+ * bytes of a stream from `off`
+ */
+fe_t f_runs(stream_t *s, long off, long len, long minlen, fl_t *out);
+
+/*
+ * Free a list of runs
+ */
+void f_free(fl_t *list);
+
+/*
+ * Encode a value of a type such as `u16`, `i64be` or `f32`: both byte orders
+ * unless `le` or `be` is given. Integers may be decimal, hex or octal.
+ */
+fe_t f_value(cstr type, cstr value, fv_t *out);
+
+/*
+ * Find every encoding of a value at once in `len` bytes of a stream from
+ * `off`, only at offsets multiple of `align`, keeping the first `max` hits
+ * and the offsets of the first `keep` (0 for all)
+ */
+fe_t f_findval(stream_t *s, long off, long len, fv_t *v, long align, long max,
+               long keep, fk_t *out);
+
+/*
+ * Free a list of values found
+ */
+void f_freehits(fk_t *list);
+
+/*
+ * Find `size` bytes XORed with any key of `keylen` bytes (1 to 8, less than
+ * `size`) in `len` bytes of a stream from `off`, keeping the first `max` hits
+ * and the offsets of the first `keep` (0 for all). Keys whose length divides
+ * `keylen` are found too.
+ */
+fe_t f_findxor(stream_t *s, long off, long len, const uint8_t *pattern,
+               long size, long keylen, long max, long keep, fq_t *out);
+
+/*
+ * Free a list of XOR patterns found
+ */
+void f_freexor(fq_t *list);
+
+/*
+ * Find the `nbits` (1 to 64) low bits of `bits`, most significant first, at
+ * any bit offset of `len` bytes of a stream from `off`, keeping the first
+ * `max` hits and the first `keep` offsets (0 for all)
+ */
+fe_t f_findbits(stream_t *s, long off, long len, uint64_t bits, long nbits,
+                long max, long keep, fs_t *out);
+
+/*
+ * Free a list of bit patterns found
+ */
+void f_freebits(fs_t *list);
+
+/*
+ * Find every occurrence of `size` bytes in `len` bytes of a stream from
+ * `off`, without overlaps. The next block is read while one is searched.
+ * fe_size if the offsets do not fit in memory.
+ */
+fe_t f_findall(stream_t *s, long off, long len, const uint8_t *pattern,
+               long size, fp_t *out);
+
+/*
+ * Add an offset to a list, fe_size if it is full or out of memory
+ */
+fe_t f_pushoffset(fp_t *list, long offset);
+
+/*
+ * Free a list of offsets
+ */
+void f_freeoffsets(fp_t *list);
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "../find.h"
+#include "../test.h"
+
+/*******************************************************************************
+ *                            Test data
+ *******************************************************************************/
+
+cstr f_path = "find.bin";
+
+/*******************************************************************************
+ *                       Test utility functions
+ *******************************************************************************/
+
+void f_util_write(uint8_t *data, long len) {
+  FILE *file = fopen(f_path, "w");
+  fwrite(data, 1, len, file);
+  fclose(file);
+}
+
+void f_util_setbits(uint8_t *data, long bit, uint64_t bits, long nbits) {
+  for (long b = 0; b < nbits; b++, bit++) {
+    if (bits >> (nbits - 1 - b) & 1) {
+      data[bit / 8] |= 0x80 >> (bit % 8);
+    }
+  }
+}
+
+/*******************************************************************************
+ *                           Test cases
+ *******************************************************************************/
+
+void f_test_runs(void) {
+  // arrange
+  long len = (1 << 20) + 4096;
+  uint8_t *data = malloc(len);
+  for (long i = 0; i < len; i++) {
+    data[i] = i * 7;
+  }
+  memset(data + 100, 0xFF, 5);
+  memset(data + 1000, 'A', 3);
+  memset(data + (1 << 20) - 50, 0, 100);
+  f_util_write(data, len);
+  free(data);
+
+  stream_t stream;
+  fl_t list;
+  s_openfile(&stream, f_path, sm_read);
+
+  // act
+  fe_t size = f_runs(&stream, 0, len, 1, &list);
+  fe_t error = f_runs(&stream, 0, len, 3, &list);
+
+  // assert
+  s_close(&stream);
+  remove(f_path);
+  t_exp("%i", fe_size, "%i", size, { f_free(&list); });
+  t_exp("%i", fe_ok, "%i", error, { f_free(&list); });
+  t_exp("%li", 3L, "%li", list.num, { f_free(&list); });
+  t_exp("%li", 100L, "%li", list.runs[0].offset, { f_free(&list); });
+  t_exp("%li", 5L, "%li", list.runs[0].size, { f_free(&list); });
+  t_exp("%i", 0xFF, "%i", list.runs[0].byte, { f_free(&list); });
+  t_exp("%li", 3L, "%li", list.runs[1].size, { f_free(&list); });
+  t_exp("%li", (1L << 20) - 50, "%li", list.runs[2].offset, { f_free(&list); });
+  t_exp("%li", 100L, "%li", list.runs[2].size, { f_free(&list); });
+  f_free(&list);
+  t_ok();
+}
+
+void f_test_runs_end(void) {
+  // arrange
+  uint8_t data[40] = {1, 2, 3};
+  f_util_write(data, sizeof(data));
+
+  stream_t stream;
+  fl_t list;
+  s_openfile(&stream, f_path, sm_read);
+
+  // act
+  fe_t error = f_runs(&stream, 1, 39, 2, &list);
+
+  // assert
+  s_close(&stream);
+  remove(f_path);
+  t_exp("%i", fe_ok, "%i", error, { f_free(&list); });
+  t_exp("%li", 1L, "%li", list.num, { f_free(&list); });
+  t_exp("%li", 3L, "%li", list.runs[0].offset, { f_free(&list); });
+  t_exp("%li", 37L, "%li", list.runs[0].size, { f_free(&list); });
+  f_free(&list);
+  t_ok();
+}
+
+void f_test_value(void) {
+  // arrange
+  fv_t both, big, zero, f64, bad;
+
+  // act
+  fe_t error = f_value("u32", "0x11223344", &both);
+  fe_t bigerror = f_value("i16be", "-2", &big);
+  f_value("u64", "0", &zero);
+  f_value("f64", "1.5", &f64);
+  fe_t type = f_value("f16", "1", &bad);
+  fe_t overflow = f_value("i16", "40000", &bad);
+  fe_t negative = f_value("u32", "-1", &bad);
+  fe_t garbage = f_value("i32", "12ab", &bad);
+
+  // assert
+  uint8_t f64bytes[8] = {0, 0, 0, 0, 0, 0, 0xF8, 0x3F};
+  t_exp("%i", fe_ok, "%i", error, {});
+  t_exp("%li", 2L, "%li", both.num, {});
+  t_exp("%i", 0x44, "%i", both.bytes[0][0], {});
+  t_exp("%i", 0x11, "%i", both.bytes[1][0], {});
+  t_exp("%i", fe_ok, "%i", bigerror, {});
+  t_exp("%li", 1L, "%li", big.num, {});
+  t_exp("%i", fo_big, "%i", big.order[0], {});
+  t_exp("%i", 0xFE, "%i", big.bytes[0][1], {});
+  t_exp("%li", 1L, "%li", zero.num, {});
+  t_exp("%i", fo_both, "%i", zero.order[0], {});
+  t_exp("%i", 0, "%i", memcmp(f64.bytes[0], f64bytes, 8), {});
+  t_exp("%i", fe_type, "%i", type, {});
+  t_exp("%i", fe_value, "%i", overflow, {});
+  t_exp("%i", fe_value, "%i", negative, {});
+  t_exp("%i", fe_value, "%i", garbage, {});
+  t_ok();
+}
+
+void f_test_findval(void) {
+  // arrange
+  long len = (1 << 20) + 4096;
+  uint8_t *data = malloc(len);
+  for (long i = 0; i < len; i++) {
+    data[i] = i * 7;
+  }
+  uint8_t le[4] = {0x44, 0x33, 0x22, 0x11};
+  uint8_t be[4] = {0x11, 0x22, 0x33, 0x44};
+  memcpy(data + 64, le, 4);
+  memcpy(data + 101, be, 4);
+  memcpy(data + (1 << 20) - 2, le, 4);
+  memcpy(data + len - 4, be, 4);
+  f_util_write(data, len);
+  free(data);
+
+  stream_t stream;
+  fv_t v;
+  fk_t any, aligned, capped;
+  f_value("u32", "0x11223344", &v);
+  s_openfile(&stream, f_path, sm_read);
+
+  // act
+  fe_t size = f_findval(&stream, 0, len, &v, 0, 10, 0, &any);
+  fe_t error = f_findval(&stream, 0, len, &v, 1, 10, 0, &any);
+  f_findval(&stream, 0, len, &v, 4, 10, 0, &aligned);
+  f_findval(&stream, 0, len, &v, 1, 1, 3, &capped);
+
+  // assert
+  s_close(&stream);
+  remove(f_path);
+  long exp[] = {64, 101, (1 << 20) - 2, len - 4};
+  int orders[] = {fo_little, fo_big, fo_little, fo_big};
+  t_exp("%i", fe_size, "%i", size, {});
+  t_exp("%i", fe_ok, "%i", error, {});
+  t_exp("%li", 4L, "%li", any.num, {});
+  for (int i = 0; i < 4; i++) {
+    t_exp("%li", exp[i], "%li", any.hits[i].offset, {});
+    t_exp("%i", orders[i], "%i", any.hits[i].order, {});
+  }
+  t_exp("%li", 2L, "%li", aligned.num, {});
+  t_exp("%li", 64L, "%li", aligned.hits[0].offset, {});
+  t_exp("%li", len - 4, "%li", aligned.hits[1].offset, {});
+  t_exp("%li", 1L, "%li", capped.num, {});
+  t_exp("%li", 4L, "%li", capped.total, {});
+  t_exp("%li", 3L, "%li", capped.offsets.num, {});
+  t_exp("%i", 1, "%i", capped.offsets.full, {});
+  t_exp("%li", 4L, "%li", any.offsets.num, {});
+  t_exp("%li", len - 4, "%li", any.offsets.offsets[3], {});
+  f_freehits(&any);
+  f_freehits(&aligned);
+  f_freehits(&capped);
+  t_ok();
+}
+
+void f_test_findxor(void) {
+  // arrange
+  long len = (1 << 20) + 4096;
+  uint8_t *data = malloc(len);
+  for (long i = 0; i < len; i++) {
+    data[i] = i * 7;
+  }
+  uint8_t pattern[6] = {'h', 'i', 'd', 'd', 'e', 'n'};
+  uint8_t key[3] = {0x13, 0x37, 0xC0};
+  for (long i = 0; i < 6; i++) {
+    data[200 + i] = pattern[i] ^ 0x5A;
+    data[(1 << 20) - 3 + i] = pattern[i] ^ key[i % 3];
+    data[len - 6 + i] = pattern[i];
+  }
+  f_util_write(data, len);
+  free(data);
+
+  stream_t stream;
+  fq_t single, repeating;
+  s_openfile(&stream, f_path, sm_read);
+
+  // act
+  fe_t size = f_findxor(&stream, 0, len, pattern, 3, 3, 10, 0, &single);
+  fe_t error = f_findxor(&stream, 0, len, pattern, 6, 1, 10, 0, &single);
+  f_findxor(&stream, 0, len, pattern, 6, 3, 10, 0, &repeating);
+
+  // assert
+  s_close(&stream);
+  remove(f_path);
+  t_exp("%i", fe_size, "%i", size, {});
+  t_exp("%i", fe_ok, "%i", error, {});
+  t_exp("%li", 2L, "%li", single.num, {});
+  t_exp("%li", 200L, "%li", single.hits[0].offset, {});
+  t_exp("%i", 0x5A, "%i", single.hits[0].key[0], {});
+  t_exp("%li", len - 6, "%li", single.hits[1].offset, {});
+  t_exp("%i", 0, "%i", single.hits[1].key[0], {});
+  t_exp("%li", 3L, "%li", repeating.num, {});
+  t_exp("%li", (1L << 20) - 3, "%li", repeating.hits[1].offset, {});
+  t_exp("%i", 0, "%i", memcmp(repeating.hits[1].key, key, 3), {});
+  f_freexor(&single);
+  f_freexor(&repeating);
+  t_ok();
+}
+
+void f_test_findbits(void) {
+  // arrange
+  long len = (1 << 20) + 4096;
+  uint8_t *data = calloc(len, 1);
+  f_util_setbits(data, 300 * 8 + 3, 0xB38F, 16);
+  f_util_setbits(data, ((1L << 20) - 1) * 8 + 5, 0xB38F, 16);
+  f_util_setbits(data, (len - 2) * 8, 0xB38F, 16);
+  f_util_write(data, len);
+  free(data);
+
+  stream_t stream;
+  fs_t list;
+  s_openfile(&stream, f_path, sm_read);
+
+  // act
+  fe_t size = f_findbits(&stream, 0, len, 0, 65, 10, 0, &list);
+  fe_t error = f_findbits(&stream, 0, len, 0xB38F, 16, 10, 0, &list);
+
+  // assert
+  s_close(&stream);
+  remove(f_path);
+  long offsets[] = {300, (1 << 20) - 1, len - 2};
+  int bits[] = {3, 5, 0};
+  t_exp("%i", fe_size, "%i", size, { f_freebits(&list); });
+  t_exp("%i", fe_ok, "%i", error, { f_freebits(&list); });
+  t_exp("%li", 3L, "%li", list.num, { f_freebits(&list); });
+  for (int i = 0; i < 3; i++) {
+    t_exp("%li", offsets[i], "%li", list.hits[i].offset, { f_freebits(&list); });
+    t_exp("%i", bits[i], "%i", list.hits[i].bit, { f_freebits(&list); });
+  }
+  f_freebits(&list);
+  t_ok();
+}
+
+void f_test_findall(void) {
+  // arrange
+  long len = 3 * (1 << 20) + 100;
+  uint8_t *data = malloc(len);
+  for (long i = 0; i < len; i++) {
+    data[i] = i * 7;
+  }
+  memcpy(data + 10, "aaaaa", 5);
+  memcpy(data + (1 << 20) - 2, "aaaa", 4);
+  memcpy(data + 2 * (1 << 20) + 5, "aa", 2);
+  memcpy(data + len - 2, "aa", 2);
+  f_util_write(data, len);
+  free(data);
+
+  stream_t stream;
+  fp_t list;
+  s_openfile(&stream, f_path, sm_read);
+
+  // act
+  fe_t size = f_findall(&stream, 0, len, (uint8_t *)"aa", 0, &list);
+  fe_t error = f_findall(&stream, 0, len, (uint8_t *)"aa", 2, &list);
+
+  // assert
+  s_close(&stream);
+  remove(f_path);
+  long exp[] = {10, 12, (1 << 20) - 2, (1 << 20), 2 * (1 << 20) + 5, len - 2};
+  t_exp("%i", fe_size, "%i", size, { f_freeoffsets(&list); });
+  t_exp("%i", fe_ok, "%i", error, { f_freeoffsets(&list); });
+  t_exp("%li", 6L, "%li", list.num, { f_freeoffsets(&list); });
+  for (int i = 0; i < 6; i++) {
+    t_exp("%li", exp[i], "%li", list.offsets[i], { f_freeoffsets(&list); });
+  }
+  f_freeoffsets(&list);
+  t_ok();
+}
+
+int main(int argc, char **argv) {
+  f_test_runs();
+  f_test_runs_end();
+  f_test_value();
+  f_test_findval();
+  f_test_findxor();
+  f_test_findbits();
+  f_test_findall();
+  return 0;
+}
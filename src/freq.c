@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "freq.h"
+
+/*******************************************************************************
+ *                       Internal utility functions
+ *******************************************************************************/
+
+/*
+ * Entropy map worker: handles every `step`th batch of blocks from `first`,
+ * read through a buffer of at most 1 MiB whatever the block size
+ */
+typedef struct {
+  stream_t *stream;
+  long off;
+  long len;
+  long first;
+  long step;
+  long batch;
+  qm_t *map;
+  uint64_t total[256];
+  qe_t err;
+} qw_t;
+
+static void *q_mapworker(void *arg) {
+  qw_t *w = arg;
+  qm_t *map = w->map;
+  long bytes = w->batch * map->blocksize;
+  long chunk = bytes < (1L << 20) ? bytes : 1L << 20;
+  uint8_t *buf = malloc(chunk);
+  assert(buf != NULL);
+
+  long batches = (map->blocks + w->batch - 1) / w->batch;
+  for (long b = w->first; b < batches && w->err == qe_ok; b += w->step) {
+    long start = b * bytes;
+    long size = w->len - start < bytes ? w->len - start : bytes;
+    uint64_t hist[256] = {0};
+
+    for (long at = 0; at < size;) {
+      long n = size - at < chunk ? size - at : chunk;
+      sb_t mem = {.data = buf, .size = n};
+      long read = 0;
+
+      if (s_readat(w->stream, &mem, w->off + start + at, &read) != se_ok ||
+          read != n) {
+        w->err = qe_read;
+        break;
+      }
+
+      // a block ends within the buffer, or goes on in the next one
+      for (long i = 0; i < n;) {
+        long left = map->blocksize - (at + i) % map->blocksize;
+        long k = n - i < left ? n - i : left;
+        q_histogram(buf + i, k, hist);
+        i += k;
+        if ((at + i) % map->blocksize != 0 && at + i != size)
+          continue;
+
+        long block = b * w->batch + (at + i - 1) / map->blocksize;
+        map->entropy[block] = q_entropy(hist);
+        for (int c = 0; c < 256; c++)
+          w->total[c] += hist[c];
+        memset(hist, 0, sizeof(hist));
+      }
+
+      at += n;
+    }
+  }
+
+  free(buf);
+  return NULL;
+}
+
+static const uint64_t q_seeds[Q_DEPTH] = {
+    0x9E3779B97F4A7C15ULL,
+    0xC2B2AE3D27D4EB4FULL,
+    0x165667B19E3779F9ULL,
+    0xD6E8FEB86659FD93ULL,
+};
+
+static uint64_t q_estimate(qn_t *q, uint64_t gram, int add) {
+  uint64_t min = UINT64_MAX;
+  for (int d = 0; d < Q_DEPTH; d++) {
+    uint64_t column = (gram * q_seeds[d]) >> (64 - Q_WIDTHBITS);
+    uint64_t *counter = &q->sketch[((uint64_t)d << Q_WIDTHBITS) + column];
+    *counter += add;
+    min = *counter < min ? *counter : min;
+  }
+  return min;
+}
+
+/*
+ * Slot of the index holding `gram`, or the empty slot where it would go
+ */
+static long q_slot(qn_t *q, uint64_t gram) {
+  long slot = (gram * q_seeds[0]) >> 32 & (q->cap - 1);
+  while (q->index[slot] >= 0 && q->heap[q->index[slot]].gram != gram)
+    slot = (slot + 1) & (q->cap - 1);
+  return slot;
+}
+
+static void q_unindex(qn_t *q, uint64_t gram) {
+  long slot = q_slot(q, gram);
+  q->index[slot] = -1;
+
+  // backward shift so that no probe sequence is cut by the new hole
+  for (long next = (slot + 1) & (q->cap - 1); q->index[next] >= 0;
+       next = (next + 1) & (q->cap - 1)) {
+    uint64_t moved = q->heap[q->index[next]].gram;
+    long home = (moved * q_seeds[0]) >> 32 & (q->cap - 1);
+    long distnext = (next - home) & (q->cap - 1);
+    long disthole = (slot - home) & (q->cap - 1);
+    if (disthole < distnext) {
+      q->index[slot] = q->index[next];
+      q->index[next] = -1;
+      slot = next;
+    }
+  }
+}
+
+static void q_swap(qn_t *q, long a, long b) {
+  long sa = q_slot(q, q->heap[a].gram);
+  long sb = q_slot(q, q->heap[b].gram);
+  qg_t tmp = q->heap[a];
+  q->heap[a] = q->heap[b];
+  q->heap[b] = tmp;
+  q->index[sa] = b;
+  q->index[sb] = a;
+}
+
+static void q_siftdown(qn_t *q, long i) {
+  for (;;) {
+    long least = i;
+    long l = 2 * i + 1, r = 2 * i + 2;
+    if (l < q->num && q->heap[l].count < q->heap[least].count)
+      least = l;
+    if (r < q->num && q->heap[r].count < q->heap[least].count)
+      least = r;
+    if (least == i)
+      return;
+    q_swap(q, i, least);
+    i = least;
+  }
+}
+
+static void q_siftup(qn_t *q, long i) {
+  while (i > 0 && q->heap[(i - 1) / 2].count > q->heap[i].count) {
+    q_swap(q, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+static void q_count(qn_t *q, uint64_t gram) {
+  uint64_t count = q_estimate(q, gram, 1);
+  q->total++;
+
+  // a gram in the heap has an estimate at least as large as the minimum
+  if (q->num == q->k && count <= q->heap[0].count)
+    return;
+
+  long slot = q_slot(q, gram);
+  if (q->index[slot] >= 0) {
+    q->heap[q->index[slot]].count = count;
+    q_siftdown(q, q->index[slot]);
+  } else if (q->num < q->k) {
+    q->heap[q->num] = (qg_t){gram, count};
+    q->index[slot] = q->num;
+    q_siftup(q, q->num++);
+  } else {
+    q_unindex(q, q->heap[0].gram);
+    q->heap[0] = (qg_t){gram, count};
+    q->index[q_slot(q, gram)] = 0;
+    q_siftdown(q, 0);
+  }
+}
+
+static int q_cmpgram(const void *a, const void *b) {
+  const qg_t *x = a;
+  const qg_t *y = b;
+  if (x->count != y->count)
+    return x->count > y->count ? -1 : 1;
+  return (x->gram > y->gram) - (x->gram < y->gram);
+}
+
+/*******************************************************************************
+ *                          Frequency functions
+ *******************************************************************************/
+
+void q_histogram(const void *data, long size, uint64_t out[256]) {
+  assert(data != NULL || size == 0);
+  assert(out != NULL);
+
+  const uint8_t *p = data;
+  const long slice = 1L << 30;
+
+  while (size > 0) {
+    // 4 tables so that runs of one byte don't serialize on one counter
+    uint32_t t[4][256] = {0};
+    long n = size < slice ? size : slice;
+    long i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+      uint64_t w;
+      memcpy(&w, p + i, sizeof(w));
+      t[0][w & 0xFF]++;
+      t[1][(w >> 8) & 0xFF]++;
+      t[2][(w >> 16) & 0xFF]++;
+      t[3][(w >> 24) & 0xFF]++;
+      t[0][(w >> 32) & 0xFF]++;
+      t[1][(w >> 40) & 0xFF]++;
+      t[2][(w >> 48) & 0xFF]++;
+      t[3][w >> 56]++;
+    }
+
+    for (; i < n; i++)
+      t[0][p[i]]++;
+
+    for (int c = 0; c < 256; c++)
+      out[c] += (uint64_t)t[0][c] + t[1][c] + t[2][c] + t[3][c];
+
+    p += n;
+    size -= n;
+  }
+}
+
+double q_entropy(const uint64_t hist[256]) {
+  assert(hist != NULL);
+
+  uint64_t total = 0;
+  for (int c = 0; c < 256; c++)
+    total += hist[c];
+
+  if (total == 0)
+    return 0;
+
+  // H = log2(N) - sum(n * log2(n)) / N
+  double sum = 0;
+  for (int c = 0; c < 256; c++) {
+    if (hist[c] > 0)
+      sum += hist[c] * log2((double)hist[c]);
+  }
+
+  double h = log2((double)total) - sum / total;
+  return h > 0 ? h : 0;
+}
+
+qe_t q_map(stream_t *s, long off, long len, long blocksize, qm_t *out) {
+  assert(s != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (blocksize <= 0)
+    return qe_size;
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return qe_range;
+
+  if ((len + blocksize - 1) / blocksize > Q_MAXBLOCKS)
+    return qe_size;
+
+  out->blocksize = blocksize;
+  out->blocks = (len + blocksize - 1) / blocksize;
+  out->entropy = calloc(out->blocks + 1, sizeof(float));
+  assert(out->entropy != NULL);
+
+  // small blocks are read in batches of about 1 MiB
+  long batch = (1L << 20) / blocksize;
+  batch = batch > 0 ? batch : 1;
+  long batches = (out->blocks + batch - 1) / batch;
+
+  // streams without descriptor share a stdio position: one thread only
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  long threads = s->type == st_file && fileno(s->handle) >= 0 ? cores : 1;
+  threads = threads < batches ? threads : batches;
+  threads = threads > 0 ? threads : 1;
+
+  qw_t *workers = calloc(threads, sizeof(qw_t));
+  pthread_t *ids = calloc(threads, sizeof(pthread_t));
+  assert(workers != NULL && ids != NULL);
+
+  for (long t = 0; t < threads; t++) {
+    workers[t] = (qw_t){.stream = s, .off = off, .len = len, .first = t,
+                        .step = threads, .batch = batch, .map = out};
+    if (t > 0)
+      pthread_create(&ids[t], NULL, q_mapworker, &workers[t]);
+  }
+
+  q_mapworker(&workers[0]);
+  for (long t = 0; t < threads; t++) {
+    if (t > 0)
+      pthread_join(ids[t], NULL);
+    for (int c = 0; c < 256; c++)
+      out->total[c] += workers[t].total[c];
+    if (workers[t].err != qe_ok)
+      workers[0].err = workers[t].err;
+  }
+
+  qe_t err = workers[0].err;
+  free(ids);
+  free(workers);
+  return err;
+}
+
+void q_free(qm_t *map) {
+  assert(map != NULL);
+  free(map->entropy);
+  memset(map, 0, sizeof(*map));
+}
+
+qe_t q_ngraminit(qn_t *out, long n, long k) {
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (n < 1 || n > 8 || k < 1 || k > 4096)
+    return qe_size;
+
+  out->n = n;
+  out->k = k;
+  out->cap = 16;
+  while (out->cap < 2 * k)
+    out->cap *= 2;
+
+  out->sketch = calloc((size_t)Q_DEPTH << Q_WIDTHBITS, sizeof(uint64_t));
+  out->heap = calloc(k, sizeof(qg_t));
+  out->index = malloc(sizeof(int32_t) * out->cap);
+  assert(out->sketch != NULL && out->heap != NULL && out->index != NULL);
+  memset(out->index, 0xFF, sizeof(int32_t) * out->cap);
+  return qe_ok;
+}
+
+void q_ngramupdate(qn_t *q, const void *data, long size) {
+  assert(q != NULL);
+  assert(data != NULL || size == 0);
+
+  // the last n bytes, the most recent in the lowest byte
+  const uint8_t *p = data;
+  uint64_t mask = q->n == 8 ? UINT64_MAX : (1ULL << (8 * q->n)) - 1;
+  for (long i = 0; i < size; i++) {
+    q->gram = ((q->gram << 8) | p[i]) & mask;
+    if (++q->seen >= q->n)
+      q_count(q, q->gram);
+  }
+}
+
+qe_t q_ngramstream(stream_t *s, long off, long len, qn_t *q) {
+  assert(s != NULL);
+  assert(q != NULL);
+
+  if (off < 0 || len < 0 || off + len > s->size)
+    return qe_range;
+
+  const long block = 1 << 20;
+  uint8_t *buf = malloc(block);
+  assert(buf != NULL);
+
+  for (long done = 0; done < len;) {
+    long size = len - done < block ? len - done : block;
+    sb_t mem = {.data = buf, .size = size};
+    long read = 0;
+
+    if (s_readat(s, &mem, off + done, &read) != se_ok || read != size) {
+      free(buf);
+      return qe_read;
+    }
+
+    q_ngramupdate(q, buf, size);
+    done += size;
+  }
+
+  free(buf);
+  return qe_ok;
+}
+
+long q_ngramtop(qn_t *q, qg_t *out) {
+  assert(q != NULL);
+  assert(out != NULL);
+
+  memcpy(out, q->heap, sizeof(qg_t) * q->num);
+  qsort(out, q->num, sizeof(qg_t), q_cmpgram);
+  return q->num;
+}
+
+void q_ngramfree(qn_t *q) {
+  assert(q != NULL);
+  free(q->sketch);
+  free(q->heap);
+  free(q->index);
+  memset(q, 0, sizeof(*q));
+}
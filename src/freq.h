@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stream.h"
+#include "typedef.h"
+
+/*******************************************************************************
+ *                        Frequency object definitions
+ *******************************************************************************/
+
+/*
+ * Frequency error codes
+ */
+typedef enum { qe_ok, qe_read, qe_range, qe_size } qe_t;
+
+/*
+ * Most blocks in an entropy map (64 MiB of values)
+ */
+#define Q_MAXBLOCKS (1L << 24)
+
+/*
+ * Entropy map of a stream range, one value per block
+ */
+typedef struct {
+  float *entropy;
+  long blocks;
+  long blocksize;
+  uint64_t total[256];
+} qm_t;
+
+/*
+ * N-gram and its (estimated) count
+ */
+typedef struct {
+  uint64_t gram;
+  uint64_t count;
+} qg_t;
+
+/*
+ * Top-k n-grams: a count-min sketch of every n-gram, and a min-heap of the
+ * k most frequent ones indexed by an open-addressing table of heap positions
+ */
+typedef struct {
+  uint64_t *sketch;
+  qg_t *heap;
+  long num;
+  long k;
+  int32_t *index;
+  long cap;
+  long n;
+  uint64_t gram;
+  long seen;
+  uint64_t total;
+} qn_t;
+
+/*
+ * Count-min sketch dimensions: 4 rows of 2^19 counters (16 MiB)
+ */
+#define Q_DEPTH 4
+#define Q_WIDTHBITS 19
+
+/*******************************************************************************
+ *                          Frequency functions
+ *******************************************************************************/
+
+/*
+ * Add the byte counts of `size` bytes to `out`
+ */
+void q_histogram(const void *data, long size, uint64_t out[256]);
+
+/*
+ * Shannon entropy of a histogram, in bits per byte (0 to 8)
+ */
+double q_entropy(const uint64_t hist[256]);
+
+/*
+ * Entropy of every block of `len` bytes from `off`, computed on every core.
+ * The last block may be shorter. There are at most Q_MAXBLOCKS blocks.
+ */
+qe_t q_map(stream_t *s, long off, long len, long blocksize, qm_t *out);
+
+/*
+ * Free an entropy map
+ */
+void q_free(qm_t *map);
+
+/*
+ * Init a top-k of n-grams, `n` from 1 to 8 and `k` from 1 to 4096
+ */
+qe_t q_ngraminit(qn_t *out, long n, long k);
+
+/*
+ * Count the n-grams of more data, including those spanning previous calls
+ */
+void q_ngramupdate(qn_t *q, const void *data, long size);
+
+/*
+ * Count the n-grams of `len` bytes of a stream from `off`
+ */
+qe_t q_ngramstream(stream_t *s, long off, long len, qn_t *q);
+
+/*
+ * Copy the top n-grams to `out` (k entries), most frequent first, and get
+ * how many there are. Counts may be overestimated, never underestimated.
+ */
+long q_ngramtop(qn_t *q, qg_t *out);
+
+/*
+ * Free a top-k of n-grams
+ */
+void q_ngramfree(qn_t *q);
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "../freq.h"
+#include "../test.h"
+
+/*******************************************************************************
+ *                            Test data
+ *******************************************************************************/
+
+cstr q_path = "freq.bin";
+
+/*******************************************************************************
+ *                       Test utility functions
+ *******************************************************************************/
+
+long q_util_milli(double bits) { return lround(bits * 1000); }
+
+/*******************************************************************************
+ *                           Test cases
+ *******************************************************************************/
+
+void q_test_histogram(void) {
+  // arrange
+  uint64_t hist[256] = {0};
+  uint8_t data[1027];
+  for (long i = 0; i < 1027; i++) {
+    data[i] = i;
+  }
+
+  // act
+  q_histogram(data, sizeof(data), hist);
+  q_histogram("AA", 2, hist);
+
+  // assert
+  t_exp("%lu", 5UL, "%lu", hist[0], {});
+  t_exp("%lu", 5UL, "%lu", hist[2], {});
+  t_exp("%lu", 4UL, "%lu", hist[3], {});
+  t_exp("%lu", 6UL, "%lu", hist['A'], {});
+  t_ok();
+}
+
+void q_test_entropy(void) {
+  // arrange
+  uint64_t uniform[256];
+  uint64_t single[256] = {[7] = 100};
+  uint64_t half[256] = {[1] = 3, [2] = 3};
+  for (int c = 0; c < 256; c++) {
+    uniform[c] = 42;
+  }
+
+  // act
+  double eight = q_entropy(uniform);
+  double zero = q_entropy(single);
+  double one = q_entropy(half);
+
+  // assert
+  t_exp("%li", 8000L, "%li", q_util_milli(eight), {});
+  t_exp("%li", 0L, "%li", q_util_milli(zero), {});
+  t_exp("%li", 1000L, "%li", q_util_milli(one), {});
+  t_ok();
+}
+
+void q_test_map(void) {
+  // arrange
+  FILE *file = fopen(q_path, "w");
+  for (long i = 0; i < 3 * 4096; i++) {
+    fputc(i < 4096 ? 0 : i < 8192 ? i : i & 1, file);
+  }
+  fputs("AB", file);
+  fclose(file);
+
+  stream_t stream;
+  s_openfile(&stream, q_path, sm_read);
+  qm_t map;
+
+  // act
+  qe_t range = q_map(&stream, 1, stream.size, 4096, &map);
+  qe_t size = q_map(&stream, 0, stream.size, 0, &map);
+  qe_t error = q_map(&stream, 0, stream.size, 4096, &map);
+
+  // assert
+  s_close(&stream);
+  remove(q_path);
+  t_exp("%i", qe_ok, "%i", error, { q_free(&map); });
+  t_exp("%i", qe_range, "%i", range, { q_free(&map); });
+  t_exp("%i", qe_size, "%i", size, { q_free(&map); });
+  t_exp("%li", 4L, "%li", map.blocks, { q_free(&map); });
+  t_exp("%li", 0L, "%li", q_util_milli(map.entropy[0]), { q_free(&map); });
+  t_exp("%li", 8000L, "%li", q_util_milli(map.entropy[1]), { q_free(&map); });
+  t_exp("%li", 1000L, "%li", q_util_milli(map.entropy[2]), { q_free(&map); });
+  t_exp("%li", 1000L, "%li", q_util_milli(map.entropy[3]), { q_free(&map); });
+  t_exp("%lu", 4096UL + 2048 + 16, "%lu", map.total[0], { q_free(&map); });
+  q_free(&map);
+  t_ok();
+}
+
+void q_test_map_sparse(void) {
+  // arrange: data and holes of 1 MiB, one after the other
+  FILE *file = fopen(q_path, "w");
+  for (long mib = 0; mib < 8; mib += 2) {
+    fseek(file, mib << 20, SEEK_SET);
+    for (long i = 0; i < 1L << 20; i++)
+      fputc(i, file);
+  }
+  fseek(file, (8L << 20) - 1, SEEK_SET);
+  fputc(0, file);
+  fclose(file);
+
+  stream_t stream;
+  s_openfile(&stream, q_path, sm_read);
+  s_move(&stream, 123);
+  qm_t map;
+
+  // act
+  qe_t error = q_map(&stream, 0, stream.size, 1L << 20, &map);
+  int next = fgetc(stream.handle);
+
+  // assert
+  s_close(&stream);
+  remove(q_path);
+  t_exp("%i", qe_ok, "%i", error, { q_free(&map); });
+  t_exp("%i", 123, "%i", next, { q_free(&map); });
+  for (long b = 0; b < 8; b++) {
+    long expected = b & 1 ? 0 : 8000;
+    t_exp("%li", expected, "%li", q_util_milli(map.entropy[b]),
+          { q_free(&map); });
+  }
+  q_free(&map);
+  t_ok();
+}
+
+void q_test_map_large(void) {
+  // arrange: blocks of 3 MiB, more than a read, after which is a hole
+  FILE *file = fopen(q_path, "w");
+  for (long i = 0; i < 3L << 20; i++)
+    fputc(i, file);
+  fseek(file, (20L << 20) - 1, SEEK_SET);
+  fputc(0, file);
+  fclose(file);
+
+  stream_t stream;
+  s_openfile(&stream, q_path, sm_read);
+  qm_t map, tiny;
+
+  // act
+  qe_t error = q_map(&stream, 0, stream.size, 3L << 20, &map);
+  qe_t size = q_map(&stream, 0, stream.size, 1, &tiny);
+
+  // assert
+  s_close(&stream);
+  remove(q_path);
+  t_exp("%i", qe_ok, "%i", error, { q_free(&map); });
+  t_exp("%i", qe_size, "%i", size, { q_free(&map); });
+  t_exp("%li", 7L, "%li", map.blocks, { q_free(&map); });
+  t_exp("%li", 8000L, "%li", q_util_milli(map.entropy[0]), { q_free(&map); });
+  for (long b = 1; b < 7; b++)
+    t_exp("%li", 0L, "%li", q_util_milli(map.entropy[b]), { q_free(&map); });
+  t_exp("%lu", (3UL << 12) + (17UL << 20), "%lu", map.total[0],
+        { q_free(&map); });
+  q_free(&map);
+  t_ok();
+}
+
+void q_test_ngrams(void) {
+  // arrange
+  qn_t top;
+  qg_t grams[3];
+  uint8_t data[4096];
+  uint64_t seed = 1;
+  for (long i = 0; i < 4096; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    data[i] = seed >> 56;
+  }
+  memcpy(data + 100, "ABCABCABC", 9);
+  memcpy(data + 2000, "ABCAB", 5);
+
+  // act
+  qe_t size = q_ngraminit(&top, 9, 3);
+  qe_t error = q_ngraminit(&top, 3, 3);
+  q_ngramupdate(&top, data, 1000);
+  q_ngramupdate(&top, data + 1000, 3096);
+  long num = q_ngramtop(&top, grams);
+  uint64_t total = top.total;
+  q_ngramfree(&top);
+
+  // assert
+  t_exp("%i", qe_size, "%i", size, {});
+  t_exp("%i", qe_ok, "%i", error, {});
+  t_exp("%li", 3L, "%li", num, {});
+  t_exp("%lu", 4094UL, "%lu", total, {});
+  t_exp("%lx", 0x414243UL, "%lx", grams[0].gram, {});
+  t_exp("%lu", 4UL, "%lu", grams[0].count, {});
+  t_exp("%lx", 0x424341UL, "%lx", grams[1].gram, {});
+  t_exp("%lu", 3UL, "%lu", grams[1].count, {});
+  t_ok();
+}
+
+int main(int argc, char **argv) {
+  q_test_histogram();
+  q_test_entropy();
+  q_test_map();
+  q_test_map_sparse();
+  q_test_map_large();
+  q_test_ngrams();
+  return 0;
+}
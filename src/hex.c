@@ -38,82 +38,161 @@
  *                            Internal functions
  *******************************************************************************/
 
-static void h_byte2hex(int8_t *ascii_ch, h3_t *out) {
-  static const int8_t hexchars[] = {'0', '1', '2', '3', '4', '5', '6', '7',
-                                    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-  int8_t ch = *ascii_ch;
-  int low = ch & 0x0F;
-  int high = (ch & 0xF0) >> 4;
-  (*out)[0] = hexchars[high];
-  (*out)[1] = hexchars[low];
-  if (ch < 0x20 || ch >= 0x7F)
-    (*ascii_ch) = '.';
+static void h_cell(hc16_t out, cstr color, char ch0, char ch1, long n) {
+  const char reset[] = "\x1b[0m";
+  char chars[] = {ch0, ch1, '\0'};
+  chars[n] = '\0';
+
+  if (color != NULL)
+    snprintf(out, sizeof(hc16_t), "%s%s%s", color, chars, reset);
   else
-    (*ascii_ch) = ch;
+    snprintf(out, sizeof(hc16_t), "%s", chars);
+}
+
+static void h_cellinit(hc_t *out, int color) {
+  static const char hexchars[] = "0123456789ABCDEF";
+
+  // 5 byte prefixes so that every cell of a table has the same length
+  cstr zero = "\x1b[90m";
+  cstr print = "\x1b[36m";
+  cstr space = "\x1b[32m";
+  cstr control = "\x1b[35m";
+  cstr high = "\x1b[33m";
+  cstr empty = "\x1b[39m";
+
+  for (int ch = 0; ch < 256; ch++) {
+    cstr prefix = print;
+    if (ch == 0)
+      prefix = zero;
+    else if (ch >= 0x80)
+      prefix = high;
+    else if (ch == ' ' || (ch >= '\t' && ch <= '\r'))
+      prefix = space;
+    else if (ch < 0x20 || ch == 0x7F)
+      prefix = control;
+
+    char glyph = (ch < 0x20 || ch >= 0x7F) ? '.' : ch;
+    prefix = color ? prefix : NULL;
+    h_cell(out->hex[ch], prefix, hexchars[ch >> 4], hexchars[ch & 15], 2);
+    h_cell(out->ascii[ch], prefix, glyph, '\0', 1);
+  }
+
+  h_cell(out->hex[256], color ? empty : NULL, ' ', ' ', 2);
+  h_cell(out->ascii[256], color ? empty : NULL, ' ', '\0', 1);
+  out->hexsz = strlen(out->hex[256]);
+  out->asciisz = strlen(out->ascii[256]);
 }
 
-static void h_empty2hex(int8_t *ascii_ch, h3_t *out) {
-  (*out)[0] = ' ';
-  (*out)[1] = ' ';
-  *ascii_ch = ' ';
+static hc_t *h_cells(int color) {
+  static hc_t tables[2];
+  static int ready[2];
+  static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+  color = color != 0;
+
+  // the workers of the server may view at once
+  pthread_mutex_lock(&lock);
+  if (!ready[color]) {
+    h_cellinit(&tables[color], color);
+    ready[color] = 1;
+  }
+  pthread_mutex_unlock(&lock);
+
+  return &tables[color];
 }
 
 static void h_readrow(stream_t *s, long *len, hr_t *out, long off, long end) {
-  int quad = 0;
-  long length = 0;
-  out->zero = 0;
-  out->zero1 = 0;
+  long read = 0;
+  long size = end - off < 16 ? end - off : 16;
+  sb_t mem = {.data = out->bytes, .size = size};
+  s_read(s, &mem, &read);
+  *len = read;
+}
 
-  for (size_t i = 0; i < sizeof(out->ascii); i++) {
-    long read = 0;
-    int err = 0;
-    int8_t *ascii_ptr = &out->ascii[i];
+static void h_rowtext(hr_t *out, hc_t *hc, long len) {
+  // every 4 bytes, display a vertical bar
+  static const char bars[] = {' ', ' ', ' ', '|'};
 
-    // read only if within desired size
-    if (off + i < end) {
-      err = s_readbyte(s, ascii_ptr, &read);
-    }
+  // bytes past the end of the row map to the empty cell (256)
+  long ndx[16];
+  for (long i = 0; i < 16; i++) {
+    long pad = i >= len;
+    ndx[i] = ((uint8_t)out->bytes[i] & (pad - 1)) | (pad << 8);
+  }
 
-    // if read was valid, proceed to conversion
-    if (err == 0 && read == 1) {
-      h_byte2hex(ascii_ptr, out->hex + i);
-      length++;
-    } else {
-      h_empty2hex(ascii_ptr, out->hex + i);
-    }
+  // cells are copied whole and overlapped by the next one, so the hex
+  // part must be complete before the ascii part is written after it.
+  char *hex = out->text;
+  for (long i = 0; i < 16; i++) {
+    memcpy(hex, hc->hex[ndx[i]], sizeof(hc16_t));
+    hex += hc->hexsz;
+    *hex++ = bars[i & 3];
+  }
 
-    // every 4 bytes, display a vertical bar
-    quad++;
-    out->hex[i][2] = (quad & 4) ? '|' : ' ';
-    quad &= 3;
+  char *ascii = hex;
+  for (long i = 0; i < 16; i++) {
+    memcpy(ascii, hc->ascii[ndx[i]], sizeof(hc16_t));
+    ascii += hc->asciisz;
   }
 
-  *len = length;
+  *ascii = '\0';
 }
 
-static int h_showhex(stream_t *stream, long size) {
+static int h_showhex(stream_t *stream, long size, int color) {
   int err;
 
   // offset
   long offset;
   err = s_pos(stream, &offset);
-  check_he(err, printf("Failed to get stream pos; error code %i\n", err));
+  check_he(err, a_printf("Failed to get stream pos; error code %i\n", err));
 
   // header
   const char space[] = ".....offset.....";
   const char hxdcm[] = ".0..1..2..3|.4..5..6..7|.8..9..A..B|.C..D..E..F|";
   const char ascii[] = "0123456789ABCDEF";
-  printf("%s|%s%s\n", space, hxdcm, ascii);
+  a_printf("%s|%s%s\n", space, hxdcm, ascii);
 
   // row
   hr_t row = {0};
+  hc_t *cells = h_cells(color);
   long length = 16;
-  long start = offset;
   long end = offset + size;
+  long start = offset;
+  long folded = 0;
+  long data = offset, hole = offset;
+  v16_t previous = {0};
 
+  // rows repeating the previous one are folded into a single '*'
   while (length == 16 && offset < end) {
+    // holes of sparse files are labelled instead of being read
+    if (offset >= hole) {
+      s_extent(stream, offset, &data, &hole);
+      long skip = (data < end ? data : end) - offset;
+
+      if (skip >= 16) {
+        a_printf("%016lx|hole of %li bytes\n", offset, skip);
+        offset += skip;
+        start = offset;
+        folded = 0;
+        s_move(stream, offset);
+        continue;
+      }
+    }
+
     h_readrow(stream, &length, &row, offset, end);
-    printf("%016lx|%s%s\n", offset, row.allhex, row.ascii);
+    v16_t current = v_load(row.bytes);
+    int repeated = offset != start && length == 16;
+    repeated = repeated && v_none(current ^ previous);
+    previous = current;
+
+    if (!repeated || offset + length >= end) {
+      h_rowtext(&row, cells, length);
+      a_printf("%016lx|%s\n", offset, row.text);
+      folded = 0;
+    } else if (!folded) {
+      a_puts("*");
+      folded = 1;
+    }
+
     offset += length;
   }
 
@@ -124,10 +203,14 @@ static int h_pos_size(stream_t *stream, long *pos, long *size) {
   int err;
 
   err = s_pos(stream, pos);
-  check_he(err, { printf("Unable to get stream pos; error code %i\n", err); });
+  check_he(err, {
+    a_printf("Unable to get stream pos; error code %i\n", err);
+  });
 
   err = s_length(stream, size);
-  check_he(err, { printf("Unable to get stream size; error code %i\n", err); });
+  check_he(err, {
+    a_printf("Unable to get stream size; error code %i\n", err);
+  });
 
   return he_ok;
 }
@@ -135,10 +218,10 @@ static int h_pos_size(stream_t *stream, long *pos, long *size) {
 static int h_check(app_t *app, ha_t *args, long expctd, hexapp_t **hexapp) {
   assert(app != NULL && args != NULL);
   long argc = args->argc;
-  check_args(argc, expctd, { printf("Expected %li arguments.\n", expctd); });
+  check_args(argc, expctd, { a_printf("Expected %li arguments.\n", expctd); });
 
   *hexapp = (hexapp_t *)app;
-  check_occupied((*hexapp)->hex.state, { puts("Stream is not in use."); });
+  check_occupied((*hexapp)->hex->state, { a_puts("Stream is not in use."); });
 
   return he_ok;
 }
@@ -149,7 +232,7 @@ static int h_fndpttrn(hexapp_t *ha, ha_t *args, long pos, long sz, sb_t *pmem) {
   // 2nd arg : range
   long range;
   err = a_arg2long(args->argv[2], &range);
-  check_he(err, { printf("Failed to parse range; error code %i.\n", err); });
+  check_he(err, { a_printf("Failed to parse range; error code %i.\n", err); });
 
   if (range <= 0 || pos + range > sz) {
     range = sz - pos;
@@ -160,239 +243,2647 @@ static int h_fndpttrn(hexapp_t *ha, ha_t *args, long pos, long sz, sb_t *pmem) {
   stream_t stream;
 
   err = s_openmem(&stream, pmem, sm_binary_read);
-  check_he(err, { printf("Stream of pattern failed; error code: %i\n", err); });
+  check_he(err, {
+    a_printf("Stream of pattern failed; error code: %i\n", err);
+  });
 
+  // the range is counted from where the search started
+  long end = pos + range;
+  f_freeoffsets(&ha->hex->hits);
+  ha->hex->hits.max = ha->maxhits;
   while (err == se_ok) {
-    err = s_seek(&ha->hex.stream, &stream, 1, &which, range);
+    err = s_seek(&ha->hex->stream, &stream, 1, &which, end - pos);
 
     if (err == se_ok) {
-      err = s_pos(&ha->hex.stream, &pos);
+      err = s_pos(&ha->hex->stream, &pos);
       for (char *c = pmem->data; c != pmem->data + pmem->size; c++) {
-        printf("%hhX ", *c);
+        a_printf("%hhX ", *c);
       }
-      printf(" @ %li\n", pos - pmem->size);
+      a_printf(" @ %li\n", pos - pmem->size);
+      f_pushoffset(&ha->hex->hits, pos - pmem->size);
       match++;
     }
   }
 
   s_close(&stream);
+  if (ha->hex->hits.full) {
+    a_printf("Warning: only the first %li offsets are kept for {}.\n",
+             ha->hex->hits.num);
+  }
+
   if (err == se_nomatch) {
     if (match > 0) {
-      printf("%li matches. \n", match);
+      a_printf("%li matches. \n", match);
       return he_ok;
     }
 
     else {
-      printf("Zero matches. \n");
+      a_printf("Zero matches. \n");
       return se_nomatch;
     }
   }
 
   else {
-    printf("Error code %i.\n", err);
+    a_printf("Error code %i.\n", err);
     return err;
   }
 }
 
-/*******************************************************************************
- *                            Hex functions
- *******************************************************************************/
-
-int h_init(hexapp_t *app) {
-  assert(app != NULL);
+static uint32_t h_diffmask(int8_t *a, int8_t *b, long len) {
+  if (len == 16)
+    return v_diffmask(a, b);
 
-  ac_t commands[] = {
-      a_command("open", "open a file", h_open),
-      a_command("close", "close loaded file", h_close),
-      a_command("move", "move stream position", h_move),
-      a_command("view", "view stream bytes", h_view),
-      a_command("quit", "close loaded file & quit", h_quit),
-      a_command("find", "find a pattern in file", h_find),
-      a_command("findx", "find an hex pattern in file", h_findx),
-      a_command("help", "The help menu", a_help),
-  };
+  uint32_t mask = 0;
+  for (long i = 0; i < len; i++)
+    mask |= (uint32_t)(a[i] != b[i]) << i;
+  return mask;
+}
 
-  ap_t ap = {
-      .commands = commands,
-      .cmdnum = sizeof(commands) / sizeof(commands[0]),
-      .name = "hexchunk",
-      .version = a_version(1, 0, 0),
-  };
+static void h_diffhex(char *out, int8_t *bytes, long len, uint32_t mask,
+                      int color) {
+  static const char bars[] = {' ', ' ', ' ', '|'};
+
+  for (long i = 0; i < 16; i++) {
+    uint8_t byte = bytes[i];
+    int differs = (mask >> i) & 1;
+
+    // in plain mode, identical bytes are elided to make changes stand out
+    if (i >= len)
+      out += sprintf(out, "  ");
+    else if (differs && color)
+      out += sprintf(out, "\x1b[1;31m%02X\x1b[0m", byte);
+    else if (differs || color)
+      out += sprintf(out, "%02X", byte);
+    else
+      out += sprintf(out, "..");
+
+    *out++ = bars[i & 3];
+  }
 
-  int err = a_init(&app->app, &ap);
-  check_he(err, { puts("Failed to load base app."); });
-  app->hex.state = hs_ready;
-  return he_ok;
+  *out = '\0';
 }
 
-void h_deinit(hexapp_t *app) {
-  assert(app != NULL);
+static void h_diffrange(hd_t **ranges, long *num, long start, long end) {
+  hd_t *last = *num > 0 ? &(*ranges)[*num - 1] : NULL;
 
-  if (app->hex.state == hs_occupied) {
-    p_deinit(&app->hex.path);
-    s_close(&app->hex.stream);
+  // differences less than a row apart belong to the same range
+  if (last != NULL && start - last->end < 16) {
+    last->end = end;
+    return;
   }
 
-  a_deinit(&app->app);
-  memset(app, 0, sizeof(*app));
+  if ((*num & (*num - 1)) == 0) {
+    *ranges = realloc(*ranges, sizeof(hd_t) * (*num ? *num * 2 : 1));
+    assert(*ranges != NULL);
+  }
+
+  (*ranges)[(*num)++] = (hd_t){.start = start, .end = end};
 }
 
-int h_open(app_t *app, ha_t *args) {
-  assert(app != NULL);
-  assert(args != NULL);
-  hexapp_t *ha = (hexapp_t *)app;
-  int err;
+static void h_tablerow(cstr label, rl_t *layout, rv_t *values, long *widths) {
+  char cell[32];
+  a_printf("%16s", label);
+  for (long f = 0; f < layout->num; f++) {
+    r_format(&layout->fields[f], values[f], cell, sizeof(cell));
+    a_printf("|%*s", (int)widths[f], cell);
+  }
+  a_printf("\n");
+}
 
-  check_args(args->argc, 2, { puts("Expected 2 arguments."); });
-  check_ready(ha->hex.state, { puts("Stream is already in use."); });
+/*
+ * Decode hex digits to `out`, which holds half as many bytes rounded up. An
+ * odd count of digits starts with a single digit byte.
+ */
+static int h_hexbytes(cstr digits, uint8_t *out, long *size) {
+  long length = strlen(digits);
+  *size = (length + 1) / 2;
+
+  for (long i = 0; i < length; i++) {
+    unsigned char ch = digits[i];
+    int value = isdigit(ch) ? ch - '0' : tolower(ch) - 'a' + 10;
+    if (!isxdigit(ch)) {
+      a_printf("Invalid digit @ pos %li (%c)\n", i, ch);
+      return he_number;
+    }
 
-  ps_t ps = p_decayed(args->argv[1]);
-  err = p_init(&ha->hex.path, &ps);
-  check_he(err, { printf("Path is invalid; error code %i.\n", err); });
+    long nibble = i + (length & 1);
+    if (nibble % 2 == 0)
+      out[nibble / 2] = 0;
+    out[nibble / 2] |= value << (nibble % 2 == 0 ? 4 : 0);
+  }
 
-  err = s_openfile(&ha->hex.stream, args->argv[1], sm_binary_read);
+  return he_ok;
+}
+
+/*
+ * Switch the stream over to the edited content on the first edit
+ */
+static int h_editable(hex_t *hex) {
+  if (hex->edit.original != NULL)
+    return he_ok;
+
+  long pos;
+  s_pos(&hex->stream, &pos);
+  hex->file = hex->stream;
+  e_init(&hex->edit, &hex->file);
+
+  int err = e_stream(&hex->edit, &hex->stream);
   check_he(err, {
-    printf("Failed to open file; error code %i.\n", err);
-    p_deinit(&ha->hex.path);
+    e_free(&hex->edit);
+    hex->stream = hex->file;
   });
 
-  ha->hex.state = hs_occupied;
-  printf("File '%s' successfully opened.\n", args->argv[1]);
+  s_move(&hex->stream, pos);
   return he_ok;
 }
 
-int h_close(app_t *app, ha_t *args) {
-  int err;
-  hexapp_t *ha;
+/*
+ * Resize the stream to the edited content and go back to `pos`
+ */
+static void h_edited(hex_t *hex, long pos) {
+  // offsets found before an insert or delete may point elsewhere now
+  f_freeoffsets(&hex->hits);
+  hex->edits++;
+  hex->stream.size = hex->edit.size;
+  s_move(&hex->stream, pos < hex->edit.size ? pos : hex->edit.size);
+}
 
-  err = h_check(app, args, 1, &ha);
-  check_he(err, {});
+static void h_release(hex_t *hex) {
+  f_freeoffsets(&hex->hits);
+  s_close(&hex->stream);
+  if (hex->edit.original != NULL) {
+    e_free(&hex->edit);
+    s_close(&hex->file);
+  }
 
-  char *path;
-  p_string(&ha->hex.path, &path);
-  printf("Successfully closed %s.\n", path);
+  free(hex->buffer);
+  hex->buffer = NULL;
+}
+
+/*
+ * Read the file through a buffer of H_BUFFER bytes, counted in the budget
+ */
+static void h_buffer(hex_t *hex) {
+  if (hex->buffer == NULL)
+    hex->buffer = malloc(H_BUFFER);
+  assert(hex->buffer != NULL);
+  setvbuf(hex->stream.handle, hex->buffer, _IOFBF, H_BUFFER);
+}
+
+/*
+ * Open the file again once written, at the same position if still in it
+ */
+static int h_reopen(hex_t *hex, cstr path) {
+  long pos;
+  s_pos(&hex->stream, &pos);
+  h_release(hex);
 
-  s_close(&ha->hex.stream);
-  p_deinit(&ha->hex.path);
-  ha->hex.state = hs_ready;
+  int err = s_openfile(&hex->stream, path, sm_binary_read);
+  check_he(err, {
+    a_printf("Failed to reopen file; error code %i.\n", err);
+    p_deinit(&hex->path);
+    hex->state = hs_ready;
+  });
 
+  h_buffer(hex);
+  s_move(&hex->stream, pos < hex->stream.size ? pos : hex->stream.size);
   return he_ok;
 }
 
-int h_move(app_t *app, ha_t *args) {
-  int err;
-  hexapp_t *ha;
+/*
+ * Free slot for a file: the current one if closed, else the first closed or
+ * a new one
+ */
+static hex_t *h_slot(hexapp_t *ha) {
+  hf_t *f = &ha->files;
+  if (ha->hex != NULL && ha->hex->state == hs_ready)
+    return ha->hex;
+
+  for (long i = 0; i < f->num; i++) {
+    if (f->slots[i]->state == hs_ready)
+      return f->slots[i];
+  }
 
-  err = h_check(app, args, 2, &ha);
-  check_he(err, {});
+  if (f->num >= f->alloc) {
+    f->alloc = f->alloc > 0 ? f->alloc * 2 : 16;
+    f->slots = realloc(f->slots, sizeof(hex_t *) * f->alloc);
+    assert(f->slots != NULL);
+  }
 
-  long offset;
-  err = a_arg2long(args->argv[1], &offset);
-  check_he(err, { printf("Failed to parse offset; error code %i.\n", err); });
+  hex_t *hex = calloc(1, sizeof(hex_t));
+  assert(hex != NULL);
+  f->slots[f->num++] = hex;
+  return hex;
+}
 
-  err = s_move(&ha->hex.stream, offset);
-  check_he(err, { printf("Move to offset failed; error code %i.\n", err); });
+static long h_number(hexapp_t *ha, hex_t *hex) {
+  for (long i = 0; i < ha->files.num; i++) {
+    if (ha->files.slots[i] == hex)
+      return i + 1;
+  }
+  return 0;
+}
 
-  return he_ok;
+/*
+ * Close the stream of a file not used lately, keeping where it was
+ */
+static void h_park(hex_t *hex) {
+  s_pos(&hex->stream, &hex->pos);
+  s_close(&hex->stream);
+  free(hex->buffer);
+  hex->buffer = NULL;
+  hex->state = hs_parked;
 }
 
-int h_view(app_t *app, ha_t *args) {
-  int err;
-  hexapp_t *ha;
+/*
+ * Get a file ready for reading: reopen it if parked, then park the least
+ * recently used files beyond the budget. Edited files stay open.
+ */
+static int h_resident(hexapp_t *ha, hex_t *hex) {
+  hf_t *f = &ha->files;
+  if (hex->state == hs_parked) {
+    char *path;
+    p_string(&hex->path, &path);
+    int err = s_openfile(&hex->stream, path, sm_binary_read);
+    check_he(err, {
+      a_printf("Failed to reopen '%s'; error code %i.\n", path, err);
+    });
+
+    h_buffer(hex);
+    s_move(&hex->stream, hex->pos < hex->stream.size ? hex->pos
+                                                     : hex->stream.size);
+    hex->state = hs_occupied;
+  }
 
-  err = h_check(app, args, 2, &ha);
-  check_he(err, {});
+  hex->used = ++f->tick;
 
-  long size;
-  err = a_arg2long(args->argv[1], &size);
-  check_he(err, { printf("Failed to parse offset; error code %i.\n", err); });
+  long resident = 0;
+  for (long i = 0; i < f->num; i++)
+    resident += f->slots[i]->state == hs_occupied;
 
-  if (size < 0) {
-    puts("Size must be positive.");
-    return he_size;
+  long limit = f->budget / H_BUFFER > 1 ? f->budget / H_BUFFER : 1;
+  while (resident > limit) {
+    hex_t *lru = NULL;
+    for (long i = 0; i < f->num; i++) {
+      hex_t *h = f->slots[i];
+      if (h->state == hs_occupied && h != hex && h->edit.original == NULL &&
+          (lru == NULL || h->used < lru->used))
+        lru = h;
+    }
+
+    if (lru == NULL)
+      break;
+    h_park(lru);
+    resident--;
   }
 
-  if (size > 4096) {
-    puts("Warning: viewing is limited to 4096 bytes at a time.");
-    size = 4096;
+  return he_ok;
+}
+
+/*
+ * Offsets an argument stands for: "{}" for the hits of the last search,
+ * piped in with '|', else the one offset given
+ */
+static int h_offsets(hex_t *hex, cstr arg, long *one, long **list, long *num) {
+  if (strcmp(arg, "{}") == 0) {
+    *list = hex->hits.offsets;
+    *num = hex->hits.num;
+    if (*num == 0) {
+      a_puts("No offsets to use: pipe a search in.");
+      return he_state;
+    }
+    return he_ok;
   }
 
-  return h_showhex(&ha->hex.stream, size);
+  int err = a_arg2long(arg, one);
+  check_he(err, { a_printf("Failed to parse offset; error code %i.\n", err); });
+  *list = one;
+  *num = 1;
+  return he_ok;
 }
 
-int h_mark(app_t *app, ha_t *args);
+/*
+ * File a client of the server holds, as it was opened
+ */
+typedef struct {
+  hex_t *hex;
+  long opened;
+} hh_t;
 
-int h_unmark(app_t *app, ha_t *args);
+/*
+ * Command of a client run on a worker thread: `app` and `hex` are copies,
+ * `hex` reading the client's file through a stream of its own, and the
+ * output goes to `out`. The job is written to `wake` once done.
+ */
+typedef struct {
+  pthread_t thread;
+  hexapp_t app;
+  hex_t hex;
+  char *out;
+  size_t outsize;
+  int wake;
+} hj_t;
 
-int h_atmark(app_t *app, ha_t *args);
+/*
+ * Client of the server: its socket, its current file if `bound`, what it
+ * sent that was not run yet, and the output of its commands from `sent` to
+ * `outsize` that it did not take yet. An `ended` client sends no more. It
+ * holds the files it opened or used, reads its file from `pos`, and keeps
+ * the `hits` of its last search unless the file had edits since `edits`.
+ * `job` is its command running on a worker thread.
+ */
+typedef struct {
+  int fd;
+  hex_t *hex;
+  int bound;
+  int ended;
+  char line[1024];
+  long size;
+  char *out;
+  long outsize;
+  long sent;
+  hh_t *held;
+  long heldnum;
+  long heldalloc;
+  long pos;
+  fp_t hits;
+  long edits;
+  hj_t *job;
+} hk_t;
 
-int h_quit(app_t *app, ha_t *args) {
-  assert(app != NULL);
-  assert(args != NULL);
-  app->closed = ae_closed;
-  return he_ok;
+/*
+ * Commands that change nothing the clients share, run on worker threads,
+ * and those writing the files, waiting for the workers
+ */
+static cstr h_readers[] = {
+    "move", "view", "find", "findx", "diff", "table", "hash", "entropy",
+    "chunks", "dupes", "delta", "fuzzy", "runs", "ngrams", "findval",
+    "findxor", "findbits", "extract", "help", "quit"};
+static cstr h_writers[] = {"save", "patch"};
+
+static volatile sig_atomic_t h_stopped;
+
+static void h_stop(int sig) {
+  (void)sig;
+  h_stopped = 1;
 }
 
-int h_find(app_t *app, ha_t *args) {
-  int err;
-  hexapp_t *ha;
+/*
+ * Length of the first command a client sent, newline included, 0 if none
+ * is complete. A line filling the buffer is cut there.
+ */
+static long h_pending(hk_t *c) {
+  char *newline = memchr(c->line, '\n', c->size);
+  if (newline != NULL)
+    return newline - c->line + 1;
+  return c->size == sizeof(c->line) - 1 || c->ended ? c->size : 0;
+}
 
-  err = h_check(app, args, 3, &ha);
-  check_he(err, {});
+/*
+ * Client with a command to run: not waiting for its output to be taken nor
+ * for its last command to end
+ */
+static int h_ready(hk_t *c) {
+  return h_pending(c) > 0 && c->outsize == 0 && c->job == NULL;
+}
 
-  long position, size;
-  err = h_pos_size(&ha->hex.stream, &position, &size);
-  check_he(err, {});
+/*
+ * Client done: nothing left to run or to send
+ */
+static int h_gone(hk_t *c) {
+  return c->ended && c->size == 0 && c->outsize == 0 && c->job == NULL;
+}
 
-  str pattern = args->argv[1];
-  sb_t pmem = {.data = pattern, .size = strlen(pattern)};
-  return h_fndpttrn(ha, args, position, size, &pmem);
+/*
+ * Number of commands in the first line of a client, and of those among
+ * `names`. Unless `heads`, the arguments count as commands, as with `use`.
+ */
+static long h_commands(hk_t *c, cstr *names, size_t num, int heads,
+                       long *found) {
+  char line[sizeof(c->line)];
+  snprintf(line, sizeof(line), "%.*s", (int)h_pending(c), c->line);
+  line[strcspn(line, "\n\r")] = '\0';
+
+  long commands = 0;
+  int head = 1;
+  str save;
+  *found = 0;
+  for (str token = strtok_r(line, " ", &save); token != NULL;
+       token = strtok_r(NULL, " ", &save)) {
+    if (strcmp(token, "|") == 0) {
+      head = 1;
+      continue;
+    }
+
+    if (head || !heads) {
+      commands++;
+      for (size_t i = 0; i < num; i++)
+        *found += strcmp(token, names[i]) == 0;
+    }
+    head = 0;
+  }
+
+  return commands;
 }
 
-int h_findx(app_t *app, ha_t *args) {
-  int err;
-  hexapp_t *ha;
+/*
+ * Whether the first command of a client can run on a worker thread: each
+ * command of its pipeline is one of h_readers, and its file has no edits,
+ * their stream having a single cursor
+ */
+static int h_concurrent(hk_t *c) {
+  long readers;
+  long commands = h_commands(c, h_readers,
+                             sizeof(h_readers) / sizeof(*h_readers), 1,
+                             &readers);
+  return c->hex->edit.original == NULL && readers == commands;
+}
 
-  err = h_check(app, args, 3, &ha);
-  check_he(err, {});
+/*
+ * Whether the first command of a client may write a file the workers read
+ */
+static int h_writing(hk_t *c) {
+  long writers;
+  h_commands(c, h_writers, sizeof(h_writers) / sizeof(*h_writers), 0,
+             &writers);
+  return writers > 0;
+}
 
-  long position, size;
-  err = h_pos_size(&ha->hex.stream, &position, &size);
-  check_he(err, {});
+static int h_held(hk_t *c, hex_t *hex) {
+  for (long i = 0; i < c->heldnum; i++) {
+    if (c->held[i].hex == hex && c->held[i].opened == hex->opened)
+      return 1;
+  }
+  return 0;
+}
 
-  size_t length = strlen(args->argv[1]);
-  int8_t *pattern = malloc(sizeof(int8_t) * length);
-  assert(pattern != NULL);
-  memcpy(pattern, args->argv[1], length);
-  size_t pttrnsz = (length + (length & 1)) >> 1;
-  size_t dest = length - 1;
-  char offset[] = {'0', 'A' - 10, 'a' - 10};
-  char limits[] = {'9', 'F' - 10, 'f' - 10};
+static void h_hold(hk_t *c, hex_t *hex) {
+  if (h_held(c, hex))
+    return;
 
-  for (size_t i = length; i > 0; i--) {
-    int8_t ch = pattern[i - 1];
-    int8_t type = ((ch & 0x60) >> 5) - 1;
-    int8_t odd = (i & 1) != (length & 1);
-    int8_t value = ch - offset[type];
+  if (c->heldnum >= c->heldalloc) {
+    c->heldalloc = c->heldalloc > 0 ? c->heldalloc * 2 : 4;
+    c->held = realloc(c->held, sizeof(hh_t) * c->heldalloc);
+    assert(c->held != NULL);
+  }
+  c->held[c->heldnum++] = (hh_t){.hex = hex, .opened = hex->opened};
+}
 
-    if (value < 0 || value > limits[type]) {
-      printf("Invalid digit @ pos %zu (%c)\n", i - 1, pattern[i - 1]);
-      return he_number;
-    }
+/*
+ * Close the files of a client gone that no other client holds, but those
+ * with edits not saved
+ */
+static void h_drop(hk_t *clients, long num, hk_t *c) {
+  for (long i = 0; i < c->heldnum; i++) {
+    hex_t *hex = c->held[i].hex;
+    int kept = hex->state == hs_ready || hex->opened != c->held[i].opened ||
+               hex->edit.original != NULL;
+    for (long j = 0; j < num && !kept; j++)
+      kept = !h_gone(&clients[j]) && h_held(&clients[j], hex);
+    if (kept)
+      continue;
+
+    if (hex->state == hs_occupied)
+      h_release(hex);
+    f_freeoffsets(&hex->hits);
+    p_deinit(&hex->path);
+    hex->state = hs_ready;
+  }
 
-    value <<= (odd * 4);
-    pattern[dest] *= odd;
-    pattern[dest] |= value;
-    dest -= odd;
+  free(c->held);
+  c->held = NULL;
+  c->heldnum = c->heldalloc = 0;
+}
+
+/*
+ * Add to the output a client has yet to take
+ */
+static void h_append(hk_t *c, const char *out, size_t size) {
+  c->out = realloc(c->out, c->outsize + size);
+  assert(c->out != NULL);
+  memcpy(c->out + c->outsize, out, size);
+  c->outsize += size;
+}
+
+/*
+ * Run the first command of a client on its current file, from where the
+ * client was, then add its output and the result as a "# <result>" line to
+ * the output the client has yet to take
+ */
+static void h_runclient(hexapp_t *ha, hk_t *c) {
+  long len = h_pending(c);
+  c->line[len - (c->line[len - 1] == '\n')] = '\0';
+
+  // clients without a file share a slot until one opens a file in it
+  if (c->hex->state != hs_ready && !c->bound) {
+    ha->hex = NULL;
+    c->hex = h_slot(ha);
   }
 
-  int8_t *buf = pattern + (length - pttrnsz);
-  sb_t pmem = {.data = buf, .size = pttrnsz};
-  err = h_fndpttrn(ha, args, position, size, &pmem);
-  free(pattern);
-  return err;
+  char *out;
+  size_t size;
+  FILE *output = open_memstream(&out, &size);
+  assert(output != NULL);
+  a_redirect(output);
+
+  aa_t args;
+  hex_t *hex = c->hex;
+  ha->hex = hex;
+  ha->app.result = 0;
+
+  // other clients may have parked it, moved in it or edited it
+  if (hex->state == hs_parked)
+    h_resident(ha, hex);
+  if (hex->state == hs_occupied) {
+    if (c->edits != hex->edits)
+      f_freeoffsets(&c->hits);
+    f_freeoffsets(&hex->hits);
+    hex->hits = c->hits;
+    c->hits = (fp_t){0};
+    s_move(&hex->stream, c->pos < hex->stream.size ? c->pos
+                                                   : hex->stream.size);
+  }
+  long tick = ha->files.tick;
+
+  a_parse(&ha->app, c->line, &args);
+  if (args.argc > 0)
+    a_pipe(&ha->app, &args);
+  a_printf("# %i\n", ha->app.result);
+
+  a_redirect(NULL);
+  fclose(output);
+  h_append(c, out, size);
+  free(out);
+
+  // the offsets found stay with the client
+  if (hex != ha->hex && hex->state != hs_ready)
+    f_freeoffsets(&hex->hits);
+
+  c->hex = ha->hex;
+  c->bound = c->hex->state != hs_ready;
+  if (c->hex->state == hs_occupied) {
+    s_pos(&c->hex->stream, &c->pos);
+    c->hits = c->hex->hits;
+    c->hex->hits = (fp_t){0};
+    c->edits = c->hex->edits;
+  }
+
+  for (long i = 0; i < ha->files.num; i++) {
+    hex_t *slot = ha->files.slots[i];
+    if (slot->state != hs_ready && (slot->opened > tick || slot == c->hex))
+      h_hold(c, slot);
+  }
+
+  c->size -= len;
+  memmove(c->line, c->line + len, c->size);
 }
 
-int h_findimg(app_t *app, ha_t *args);
+static void *h_work(void *arg) {
+  hj_t *job = arg;
+  FILE *output = open_memstream(&job->out, &job->outsize);
+  assert(output != NULL);
+  a_redirect(output);
+
+  aa_t args;
+  a_parse(&job->app.app, job->app.app.input, &args);
+  if (args.argc > 0)
+    a_pipe(&job->app.app, &args);
+  a_printf("# %i\n", job->app.app.result);
+
+  a_redirect(NULL);
+  fclose(output);
+  write(job->wake, &job, sizeof(job));
+  return NULL;
+}
+
+/*
+ * Run the first command of a client on a worker thread, reading from where
+ * the client was through a stream of its own. Nothing is run if the file
+ * fails to open or the thread to start.
+ */
+static int h_startjob(hexapp_t *ha, hk_t *c, int wake) {
+  hj_t *job = calloc(1, sizeof(hj_t));
+  assert(job != NULL);
+
+  hex_t *hex = c->hex;
+  job->hex = (hex_t){.state = hs_ready, .color = hex->color};
+  if (c->bound && hex->state != hs_ready) {
+    char *path;
+    p_string(&hex->path, &path);
+    int err = s_openfile(&job->hex.stream, path, sm_binary_read);
+    check_he(err, { free(job); });
+
+    h_buffer(&job->hex);
+    s_move(&job->hex.stream, c->pos < job->hex.stream.size
+                                 ? c->pos
+                                 : job->hex.stream.size);
+    job->hex.path = hex->path;
+    job->hex.state = hs_occupied;
+    if (c->edits != hex->edits)
+      f_freeoffsets(&c->hits);
+    c->edits = hex->edits;
+  }
 
-int h_extract(app_t *app, ha_t *args);
+  // the commands and the settings are shared, the arguments are not
+  long len = h_pending(c);
+  job->app = *ha;
+  job->app.app.argbuf = NULL;
+  job->app.app.argalloc = 0;
+  job->app.app.result = 0;
+  job->app.hex = &job->hex;
+  job->wake = wake;
+  snprintf(job->app.app.input, sizeof(job->app.app.input), "%.*s", (int)len,
+           c->line);
+  job->hex.hits = c->hits;
+
+  // signals are left to the poll thread
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  int err = pthread_create(&job->thread, NULL, h_work, job);
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+  if (err != 0) {
+    if (job->hex.state == hs_occupied)
+      s_close(&job->hex.stream);
+    free(job->hex.buffer);
+    free(job);
+    return he_state;
+  }
+
+  c->hits = (fp_t){0};
+  c->job = job;
+  c->size -= len;
+  memmove(c->line, c->line + len, c->size);
+  return he_ok;
+}
+
+/*
+ * Wait for the job of a client, then take back where it read, the offsets
+ * it found and its output
+ */
+static void h_endjob(hk_t *c) {
+  hj_t *job = c->job;
+  pthread_join(job->thread, NULL);
+  if (job->hex.state == hs_occupied) {
+    s_pos(&job->hex.stream, &c->pos);
+    s_close(&job->hex.stream);
+  }
+
+  c->hits = job->hex.hits;
+  h_append(c, job->out, job->outsize);
+  if (job->app.app.closed == ae_closed) {
+    c->ended = 1;
+    c->size = 0;
+  }
+
+  free(job->hex.buffer);
+  free(job->out);
+  free(job->app.app.argbuf);
+  free(job);
+  c->job = NULL;
+}
+
+/*
+ * Send a client what its socket takes of its output, without waiting. A
+ * client whose socket fails is dropped.
+ */
+static void h_sendclient(hk_t *c) {
+  ssize_t sent = send(c->fd, c->out + c->sent, c->outsize - c->sent,
+                      MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (sent >= 0) {
+    c->sent += sent;
+  } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+    c->ended = 1;
+    c->size = 0;
+    c->sent = c->outsize;
+  }
+
+  if (c->sent == c->outsize)
+    c->outsize = c->sent = 0;
+}
+
+/*******************************************************************************
+ *                            Hex functions
+ *******************************************************************************/
+
+int h_init(hexapp_t *app) {
+  assert(app != NULL);
+
+  ac_t commands[] = {
+      a_command("open", "open a file", h_open),
+      a_command("close", "close loaded file", h_close),
+      a_command("files", "list the open files", h_files),
+      a_command("use", "switch file, or run a command on one", h_use),
+      a_command("move", "move stream position", h_move),
+      a_command("view", "view stream bytes", h_view),
+      a_command("color", "colorize byte classes (on/off)", h_color),
+      a_command("quit", "close loaded file & quit", h_quit),
+      a_command("find", "find a pattern in file", h_find),
+      a_command("findx", "find an hex pattern in file", h_findx),
+      a_command("diff", "compare with an other file", h_diff),
+      a_command("table", "decode fixed-size records", h_table),
+      a_command("hash", "hash a range (crc32c/xxh3/sha256/tree)", h_hash),
+      a_command("entropy", "map the entropy of blocks", h_entropy),
+      a_command("chunks", "content-defined chunks & stats", h_chunks),
+      a_command("dupes", "find identical blocks (fixed/cdc)", h_dupes),
+      a_command("delta", "shifted copies from an other file", h_delta),
+      a_command("fuzzy", "fuzzy digest & similarity score", h_fuzzy),
+      a_command("runs", "runs of a repeated byte & fill map", h_runs),
+      a_command("ngrams", "most frequent n-byte sequences", h_ngrams),
+      a_command("findval", "find a number in both byte orders", h_findval),
+      a_command("findxor", "find a pattern under any XOR key", h_findxor),
+      a_command("findbits", "find bits at any bit offset", h_findbits),
+      a_command("overwrite", "overwrite hex bytes (in memory)", h_overwrite),
+      a_command("insert", "insert hex bytes (in memory)", h_insert),
+      a_command("delete", "delete bytes (in memory)", h_delete),
+      a_command("replace", "replace every occurrence (in memory)", h_replace),
+      a_command("undo", "undo the last edit", h_undo),
+      a_command("redo", "redo the last edit undone", h_redo),
+      a_command("save", "write the edits to the file", h_save),
+      a_command("patch", "export the edits or apply a patch", h_patch),
+      a_command("extract", "write bytes to a file, per offset", h_extract),
+      a_command("hits", "most offsets a search keeps for {}", h_hits),
+      a_command("help", "The help menu", a_help),
+  };
+
+  ap_t ap = {
+      .commands = commands,
+      .cmdnum = sizeof(commands) / sizeof(commands[0]),
+      .name = "hexchunk",
+      .version = a_version(1, 0, 0),
+  };
+
+  int err = a_init(&app->app, &ap);
+  check_he(err, { a_puts("Failed to load base app."); });
+  app->hex = NULL;
+  app->files = (hf_t){.budget = H_BUDGET};
+  app->maxhits = H_MAXHITS;
+  app->hex = h_slot(app);
+  return he_ok;
+}
+
+void h_deinit(hexapp_t *app) {
+  assert(app != NULL);
+
+  for (long i = 0; i < app->files.num; i++) {
+    hex_t *hex = app->files.slots[i];
+    if (hex->state != hs_ready)
+      p_deinit(&hex->path);
+    if (hex->state == hs_occupied)
+      h_release(hex);
+    f_freeoffsets(&hex->hits);
+    free(hex->buffer);
+    free(hex);
+  }
+
+  free(app->files.slots);
+  a_deinit(&app->app);
+  memset(app, 0, sizeof(*app));
+}
+
+int h_serve(hexapp_t *app, cstr path) {
+  assert(app != NULL);
+  assert(path != NULL);
+
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    a_puts("Socket path is too long.");
+    return he_argc;
+  }
+  strcpy(addr.sun_path, path);
+
+  // a socket left by a server that is gone is replaced
+  struct stat st;
+  if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+    unlink(path);
+
+  // the jobs done are written there, waking the poll
+  int wake[2];
+  if (pipe(wake) != 0) {
+    a_printf("Failed to start the workers; error code %i.\n", errno);
+    return he_read;
+  }
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0 || bind(listener, (struct sockaddr *)&addr,
+                           sizeof(addr)) != 0 || listen(listener, 64) != 0) {
+    a_printf("Failed to listen on '%s'; error code %i.\n", path, errno);
+    if (listener >= 0)
+      close(listener);
+    close(wake[0]);
+    close(wake[1]);
+    return he_read;
+  }
+
+  struct sigaction stop = {.sa_handler = h_stop};
+  sigaction(SIGINT, &stop, NULL);
+  sigaction(SIGTERM, &stop, NULL);
+  signal(SIGPIPE, SIG_IGN);
+  h_stopped = 0;
+
+  a_printf("Serving on '%s'.\n", path);
+  fflush(stdout);
+
+  hk_t *clients = NULL;
+  struct pollfd *fds = NULL;
+  long num = 0, alloc = 0, running = 0;
+
+  while (!h_stopped) {
+    // commands already received are run before waiting for more, but not
+    // those of a client that has yet to take the output of the last one.
+    // A command writing the files waits for the jobs running, and no job
+    // starts meanwhile.
+    int pending = 0, waiting = 0;
+    for (long i = 0; i < num; i++)
+      waiting |= h_ready(&clients[i]) && h_writing(&clients[i]);
+
+    fds = realloc(fds, sizeof(struct pollfd) * (num + 2));
+    assert(fds != NULL);
+    fds[0] = (struct pollfd){.fd = listener, .events = POLLIN};
+    fds[1] = (struct pollfd){.fd = wake[0], .events = POLLIN};
+    for (long i = 0; i < num; i++) {
+      hk_t *c = &clients[i];
+      int full = c->size == sizeof(c->line) - 1;
+      short events = (c->ended || full ? 0 : POLLIN) |
+                     (c->outsize > 0 ? POLLOUT : 0);
+      fds[i + 2] = (struct pollfd){.fd = c->fd, .events = events};
+      if (h_ready(c))
+        pending |= h_concurrent(c) ? !waiting && running < H_JOBS
+                                   : !h_writing(c) || running == 0;
+    }
+
+    if (poll(fds, num + 2, pending ? 0 : -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      hj_t *done[64];
+      ssize_t got = read(wake[0], done, sizeof(done));
+      for (long k = 0; k < got / (ssize_t)sizeof(*done); k++) {
+        for (long i = 0; i < num; i++) {
+          if (clients[i].job != done[k])
+            continue;
+          h_endjob(&clients[i]);
+          h_sendclient(&clients[i]);
+          running--;
+        }
+      }
+    }
+
+    for (long i = 0; i < num; i++) {
+      hk_t *c = &clients[i];
+      long room = sizeof(c->line) - 1 - c->size;
+      if (c->ended || room == 0 ||
+          !(fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)))
+        continue;
+
+      // what was sent before the end is still run
+      ssize_t got = read(c->fd, c->line + c->size, room);
+      if (got > 0)
+        c->size += got;
+      else
+        c->ended = 1;
+    }
+
+    for (long i = 0; i < num; i++) {
+      if (clients[i].outsize > 0 &&
+          (fds[i + 2].revents & (POLLOUT | POLLHUP | POLLERR)))
+        h_sendclient(&clients[i]);
+    }
+
+    // one command per client and per round, so that none waits for another
+    // to send all of its commands or to read all of its output. Those only
+    // reading run on worker threads, each with its own stream, the others
+    // on this one in turn.
+    for (long i = 0; i < num; i++) {
+      hk_t *c = &clients[i];
+      if (!h_ready(c))
+        continue;
+
+      int concurrent = h_concurrent(c);
+      if (concurrent && (waiting || running >= H_JOBS))
+        continue;
+      if (concurrent && h_startjob(app, c, wake[1]) == he_ok) {
+        running++;
+        continue;
+      }
+
+      if (h_writing(c) && running > 0)
+        continue;
+
+      h_runclient(app, c);
+      if (app->app.closed == ae_closed) {
+        app->app.closed = ae_opened;
+        c->ended = 1;
+        c->size = 0;
+      }
+      h_sendclient(c);
+    }
+
+    // gone: their files stay open only while other clients hold them
+    for (long i = 0; i < num; i++) {
+      if (h_gone(&clients[i]))
+        h_drop(clients, num, &clients[i]);
+    }
+
+    long kept = 0;
+    for (long i = 0; i < num; i++) {
+      hk_t *c = &clients[i];
+      if (h_gone(c)) {
+        close(c->fd);
+        free(c->out);
+        f_freeoffsets(&c->hits);
+      } else {
+        clients[kept++] = *c;
+      }
+    }
+    num = kept;
+
+    if (fds[0].revents & POLLIN) {
+      int fd = accept(listener, NULL, NULL);
+      if (fd < 0)
+        continue;
+
+      if (num >= alloc) {
+        alloc = alloc > 0 ? alloc * 2 : 16;
+        clients = realloc(clients, sizeof(hk_t) * alloc);
+        assert(clients != NULL);
+      }
+
+      // a client starts without a current file
+      app->hex = NULL;
+      clients[num++] = (hk_t){.fd = fd, .hex = h_slot(app)};
+    }
+  }
+
+  // the jobs running are waited for, their output dropped
+  for (long i = 0; i < num; i++) {
+    hk_t *c = &clients[i];
+    if (c->job != NULL)
+      h_endjob(c);
+    close(c->fd);
+    free(c->out);
+    free(c->held);
+    f_freeoffsets(&c->hits);
+  }
+  free(clients);
+  free(fds);
+  close(wake[0]);
+  close(wake[1]);
+  close(listener);
+  unlink(path);
+  errno = 0;
+
+  // the current file of the app is one with no client
+  app->hex = h_slot(app);
+  a_puts("Server stopped.");
+  return he_ok;
+}
+
+int h_open(app_t *app, ha_t *args) {
+  assert(app != NULL);
+  assert(args != NULL);
+  hexapp_t *ha = (hexapp_t *)app;
+  int err;
+
+  check_args(args->argc, 2, { a_puts("Expected 2 arguments."); });
+
+  // a file already open is used again, whatever path names it
+  struct stat st;
+  int known = stat(args->argv[1], &st) == 0;
+  for (long i = 0; known && i < ha->files.num; i++) {
+    hex_t *open = ha->files.slots[i];
+    if (open->state == hs_ready || open->dev != st.st_dev ||
+        open->ino != st.st_ino)
+      continue;
+
+    err = h_resident(ha, open);
+    check_he(err, {});
+    s_move(&open->stream, 0);
+    ha->hex = open;
+    a_printf("File '%s' already open as #%li.\n", args->argv[1], i + 1);
+    return he_ok;
+  }
+
+  hex_t *hex = h_slot(ha);
+  ps_t ps = p_decayed(args->argv[1]);
+  err = p_init(&hex->path, &ps);
+  check_he(err, { a_printf("Path is invalid; error code %i.\n", err); });
+
+  long replayed;
+  err = e_recover(args->argv[1], &replayed);
+  if (err != ee_ok)
+    a_printf("Warning: failed to recover a save; error code %i.\n", err);
+  else if (replayed > 0)
+    a_printf("Recovered an interrupted save, %li bytes written.\n", replayed);
+
+  err = s_openfile(&hex->stream, args->argv[1], sm_binary_read);
+  check_he(err, {
+    a_printf("Failed to open file; error code %i.\n", err);
+    p_deinit(&hex->path);
+  });
+
+  fstat(fileno(hex->stream.handle), &st);
+  hex->dev = st.st_dev;
+  hex->ino = st.st_ino;
+  hex->opened = ++ha->files.tick;
+  h_buffer(hex);
+  hex->state = hs_occupied;
+  hex->color = ha->hex->color;
+  ha->hex = hex;
+  h_resident(ha, hex);
+  a_printf("File '%s' successfully opened as #%li.\n", args->argv[1],
+           h_number(ha, hex));
+  return he_ok;
+}
+
+int h_close(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 1, &ha);
+  check_he(err, {});
+
+  char *path;
+  p_string(&ha->hex->path, &path);
+  a_printf("Successfully closed %s.\n", path);
+  if (ha->hex->edit.original != NULL)
+    a_puts("Edits were discarded.");
+
+  h_release(ha->hex);
+  p_deinit(&ha->hex->path);
+  ha->hex->state = hs_ready;
+
+  return he_ok;
+}
+
+int h_move(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 2, &ha);
+  check_he(err, {});
+
+  long offset;
+  err = a_arg2long(args->argv[1], &offset);
+  check_he(err, { a_printf("Failed to parse offset; error code %i.\n", err); });
+
+  err = s_move(&ha->hex->stream, offset);
+  check_he(err, { a_printf("Move to offset failed; error code %i.\n", err); });
+
+  return he_ok;
+}
+
+int h_view(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 2 && args->argc != 3) {
+    a_puts("Expected 1 or 2 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  long size;
+  err = a_arg2long(args->argv[args->argc - 1], &size);
+  check_he(err, { a_printf("Failed to parse size; error code %i.\n", err); });
+
+  if (size < 0) {
+    a_puts("Size must be positive.");
+    return he_size;
+  }
+
+  if (size > 4096) {
+    a_puts("Warning: viewing is limited to 4096 bytes at a time.");
+    size = 4096;
+  }
+
+  if (args->argc == 2)
+    return h_showhex(&ha->hex->stream, size, ha->hex->color);
+
+  // every offset piped in is viewed from, as a move then a view
+  long one, *offsets, num;
+  err = h_offsets(ha->hex, args->argv[1], &one, &offsets, &num);
+  check_he(err, {});
+
+  for (long i = 0; i < num; i++) {
+    err = s_move(&ha->hex->stream, offsets[i]);
+    check_he(err, {
+      a_printf("Move to offset failed; error code %i.\n", err);
+    });
+    err = h_showhex(&ha->hex->stream, size, ha->hex->color);
+    check_he(err, {});
+  }
+
+  return he_ok;
+}
+
+int h_color(app_t *app, ha_t *args) {
+  assert(app != NULL);
+  assert(args != NULL);
+  hexapp_t *ha = (hexapp_t *)app;
+
+  check_args(args->argc, 2, { a_puts("Expected 2 arguments."); });
+
+  if (strcmp(args->argv[1], "on") == 0)
+    ha->hex->color = 1;
+  else if (strcmp(args->argv[1], "off") == 0)
+    ha->hex->color = 0;
+  else {
+    a_puts("Expected 'on' or 'off'.");
+    return he_number;
+  }
+
+  return he_ok;
+}
+
+int h_mark(app_t *app, ha_t *args);
+
+int h_unmark(app_t *app, ha_t *args);
+
+int h_atmark(app_t *app, ha_t *args);
+
+int h_quit(app_t *app, ha_t *args) {
+  assert(app != NULL);
+  assert(args != NULL);
+  app->closed = ae_closed;
+  return he_ok;
+}
+
+int h_find(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 3, &ha);
+  check_he(err, {});
+
+  long position, size;
+  err = h_pos_size(&ha->hex->stream, &position, &size);
+  check_he(err, {});
+
+  str pattern = args->argv[1];
+  sb_t pmem = {.data = pattern, .size = strlen(pattern)};
+  return h_fndpttrn(ha, args, position, size, &pmem);
+}
+
+int h_findx(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 3, &ha);
+  check_he(err, {});
+
+  long position, size;
+  err = h_pos_size(&ha->hex->stream, &position, &size);
+  check_he(err, {});
+
+  size_t length = strlen(args->argv[1]);
+  int8_t *pattern = malloc(sizeof(int8_t) * length);
+  assert(pattern != NULL);
+  memcpy(pattern, args->argv[1], length);
+  size_t pttrnsz = (length + (length & 1)) >> 1;
+  size_t dest = length - 1;
+  char offset[] = {'0', 'A' - 10, 'a' - 10};
+  char limits[] = {'9', 'F' - 10, 'f' - 10};
+
+  for (size_t i = length; i > 0; i--) {
+    int8_t ch = pattern[i - 1];
+    int8_t type = ((ch & 0x60) >> 5) - 1;
+    int8_t odd = (i & 1) != (length & 1);
+    int8_t value = ch - offset[type];
+
+    if (value < 0 || value > limits[type]) {
+      a_printf("Invalid digit @ pos %zu (%c)\n", i - 1, pattern[i - 1]);
+      return he_number;
+    }
+
+    value <<= (odd * 4);
+    pattern[dest] *= odd;
+    pattern[dest] |= value;
+    dest -= odd;
+  }
+
+  int8_t *buf = pattern + (length - pttrnsz);
+  sb_t pmem = {.data = buf, .size = pttrnsz};
+  err = h_fndpttrn(ha, args, position, size, &pmem);
+  free(pattern);
+  return err;
+}
+
+int h_diff(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 2, &ha);
+  check_he(err, {});
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  stream_t other;
+  err = s_openfile(&other, args->argv[1], sm_binary_read);
+  check_he(err, { a_printf("Failed to open file; error code %i.\n", err); });
+
+  err = s_move(&other, pos);
+  check_he(err, {
+    a_printf("Move to offset failed; error code %i.\n", err);
+    s_close(&other);
+  });
+
+  const char space[] = ".....offset.....";
+  const char hxdcm[] = ".0..1..2..3|.4..5..6..7|.8..9..A..B|.C..D..E..F|";
+  a_printf("%s|%s%s\n", space, hxdcm, hxdcm);
+
+  // identical blocks are skipped with vector compares, only rows
+  // holding at least one difference are rendered.
+  const long block = 1 << 20;
+  const long maxrows = 256;
+  int8_t *a = malloc(block);
+  int8_t *b = malloc(block);
+  assert(a != NULL && b != NULL);
+
+  char left[16 * 16 + 1];
+  char right[16 * 16 + 1];
+  hd_t *ranges = NULL;
+  long num = 0, rows = 0, bytes = 0;
+  long offset = pos;
+  long ra = block, rb = block;
+
+  while (ra == block && rb == block) {
+    // regions that are holes in both files are skipped whole
+    long da, db, hole;
+    s_extent(&ha->hex->stream, offset, &da, &hole);
+    s_extent(&other, offset, &db, &hole);
+    long skip = ((da < db ? da : db) - offset) & ~15L;
+    if (skip > 0) {
+      offset += skip;
+      s_move(&ha->hex->stream, offset);
+      s_move(&other, offset);
+    }
+
+    sb_t ma = {.data = a, .size = block};
+    sb_t mb = {.data = b, .size = block};
+    s_read(&ha->hex->stream, &ma, &ra);
+    s_read(&other, &mb, &rb);
+    long n = ra < rb ? ra : rb;
+
+    for (long i = 0; i < n; i += 16) {
+      i += v_same(a + i, b + i, n - i);
+      if (i >= n)
+        break;
+
+      long len = n - i < 16 ? n - i : 16;
+      uint32_t mask = h_diffmask(a + i, b + i, len);
+      if (mask == 0)
+        continue;
+
+      long first = __builtin_ctz(mask);
+      long last = 31 - __builtin_clz(mask);
+      h_diffrange(&ranges, &num, offset + i + first, offset + i + last + 1);
+      bytes += __builtin_popcount(mask);
+
+      if (rows++ < maxrows) {
+        h_diffhex(left, a + i, len, mask, ha->hex->color);
+        h_diffhex(right, b + i, len, mask, ha->hex->color);
+        a_printf("%016lx|%s%s\n", offset + i, left, right);
+      }
+    }
+
+    offset += n;
+  }
+
+  if (rows > maxrows) {
+    a_printf("Warning: display limited to %li of %li rows.\n", maxrows, rows);
+  }
+
+  // the tail of the longer file differs as a whole
+  long shorter = size < other.size ? size : other.size;
+  long longer = size < other.size ? other.size : size;
+  if (shorter < pos)
+    shorter = pos;
+  if (longer > shorter) {
+    h_diffrange(&ranges, &num, shorter, longer);
+    bytes += longer - shorter;
+  }
+
+  for (hd_t *r = ranges; r != ranges + num; r++) {
+    a_printf("%016lx-%016lx %li bytes\n", r->start, r->end, r->end - r->start);
+  }
+
+  a_printf("%li changed ranges, %li bytes differ.\n", num, bytes);
+  if (size != other.size) {
+    a_printf("Sizes differ: %li and %li bytes.\n", size, other.size);
+  }
+
+  free(ranges);
+  free(a);
+  free(b);
+  s_close(&other);
+  s_move(&ha->hex->stream, pos);
+  return he_ok;
+}
+
+int h_table(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 3, &ha);
+  check_he(err, {});
+
+  rl_t layout;
+  err = r_parse(&layout, args->argv[1]);
+  check_he(err, { a_printf("Invalid layout; error code %i.\n", err); });
+
+  long count;
+  err = a_arg2long(args->argv[2], &count);
+  check_he(err, { a_printf("Failed to parse count; error code %i.\n", err); });
+
+  if (count <= 0) {
+    a_puts("Count must be positive.");
+    return he_size;
+  }
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  long left = pos < size ? (size - pos) / layout.size : 0;
+  if (count > left) {
+    count = left;
+    a_printf("Warning: only %li complete records left.\n", count);
+  }
+
+  if (count <= 0) {
+    return he_size;
+  }
+
+  // the records, their columns and the sorted copy counting distinct values
+  // are all held at once, so their number is bounded
+  const long budget = 64L << 20;
+  long maxcount = budget / (layout.size + sizeof(rv_t) * (layout.num + 1));
+  if (count > maxcount) {
+    count = maxcount;
+    a_printf("Warning: table limited to %li records.\n", count);
+  }
+
+  // records are read in bulk and decoded column by column
+  long read;
+  long bytes = count * layout.size;
+  sb_t mem = {.data = malloc(bytes), .size = bytes};
+  assert(mem.data != NULL);
+  err = s_read(&ha->hex->stream, &mem, &read);
+  check_read(read, mem.size, {
+    a_puts("Failed to read records.");
+    free(mem.data);
+  });
+
+  rv_t *columns[sizeof(layout.fields) / sizeof(layout.fields[0])];
+  for (long f = 0; f < layout.num; f++) {
+    columns[f] = malloc(sizeof(rv_t) * count);
+    assert(columns[f] != NULL);
+  }
+
+  r_decode(&layout, mem.data, count, columns);
+
+  rs_t stats[sizeof(layout.fields) / sizeof(layout.fields[0])];
+  rv_t row[sizeof(layout.fields) / sizeof(layout.fields[0])];
+  long widths[sizeof(layout.fields) / sizeof(layout.fields[0])];
+  const long maxrows = 256;
+  long shown = count < maxrows ? count : maxrows;
+  char cell[32];
+
+  // columns are as wide as their name or their widest shown value
+  for (long f = 0; f < layout.num; f++) {
+    r_stats(&layout.fields[f], columns[f], count, &stats[f]);
+    widths[f] = strlen(layout.fields[f].name);
+    rv_t extremes[] = {stats[f].min, stats[f].max};
+    for (long r = 0; r < shown + 2; r++) {
+      rv_t value = r < shown ? columns[f][r] : extremes[r - shown];
+      long len = r_format(&layout.fields[f], value, cell, sizeof(cell));
+      widths[f] = len > widths[f] ? len : widths[f];
+    }
+  }
+
+  a_printf(".....offset.....");
+  for (long f = 0; f < layout.num; f++) {
+    a_printf("|%*s", (int)widths[f], layout.fields[f].name);
+  }
+  a_printf("\n");
+
+  for (long r = 0; r < shown; r++) {
+    char label[32];
+    snprintf(label, sizeof(label), "%016lx", pos + r * layout.size);
+    for (long f = 0; f < layout.num; f++)
+      row[f] = columns[f][r];
+    h_tablerow(label, &layout, row, widths);
+  }
+
+  if (count > shown) {
+    a_printf("Warning: display limited to %li of %li records.\n", shown, count);
+  }
+
+  for (long f = 0; f < layout.num; f++)
+    row[f] = stats[f].min;
+  h_tablerow("min", &layout, row, widths);
+
+  for (long f = 0; f < layout.num; f++)
+    row[f] = stats[f].max;
+  h_tablerow("max", &layout, row, widths);
+
+  a_printf("%16s", "distinct");
+  for (long f = 0; f < layout.num; f++) {
+    a_printf("|%*li", (int)widths[f], stats[f].distinct);
+  }
+  a_printf("\n");
+
+  for (long f = 0; f < layout.num; f++)
+    free(columns[f]);
+  free(mem.data);
+  return he_ok;
+}
+
+int h_hash(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 2 && args->argc != 4) {
+    a_puts("Expected 2 or 4 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  dk_t kind;
+  err = d_kind(args->argv[1], &kind);
+  check_he(err, { a_printf("Unknown algorithm %s.\n", args->argv[1]); });
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  // default range: from the current position to the end
+  long len = size - pos;
+  long *offsets = &pos, num = 1;
+  if (args->argc == 4) {
+    err = h_offsets(ha->hex, args->argv[2], &pos, &offsets, &num);
+    check_he(err, {});
+
+    err = a_arg2long(args->argv[3], &len);
+    check_he(err, {
+      a_printf("Failed to parse length; error code %i.\n", err);
+    });
+  }
+
+  for (long i = 0; i < num; i++) {
+    dd_t digest;
+    err = d_stream(&ha->hex->stream, kind, offsets[i], len, &digest);
+    if (err == de_range) {
+      a_puts("Range is outside of the stream.");
+      return he_size;
+    }
+    check_he(err, {
+      a_printf("Failed to hash stream; error code %i.\n", err);
+    });
+
+    char text[2 * sizeof(digest.bytes) + 1];
+    d_hex(&digest, text);
+    a_printf("%s %s %016lx+%li\n", args->argv[1], text, offsets[i], len);
+  }
+  return he_ok;
+}
+
+int h_entropy(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 1 && args->argc != 2) {
+    a_puts("Expected 1 or 2 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  long blocksize = 1 << 16;
+  if (args->argc == 2) {
+    err = a_arg2long(args->argv[1], &blocksize);
+    check_he(err, { a_printf("Failed to parse size; error code %i.\n", err); });
+  }
+
+  if (blocksize <= 0 || blocksize > (1L << 30)) {
+    a_puts("Block size must be between 1 and 1073741824.");
+    return he_size;
+  }
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  // blocks too small for the range are made larger
+  if (pos < size && (size - pos + blocksize - 1) / blocksize > Q_MAXBLOCKS) {
+    blocksize = (size - pos + Q_MAXBLOCKS - 1) / Q_MAXBLOCKS;
+    a_printf("Warning: blocks enlarged to %li bytes.\n", blocksize);
+  }
+
+  qm_t map;
+  err = q_map(&ha->hex->stream, pos, size - pos, blocksize, &map);
+  check_he(err, {
+    a_printf("Failed to map entropy; error code %i.\n", err);
+    q_free(&map);
+  });
+
+  // one cell per block, or per group of blocks showing the highest value
+  static const char levels[] = " .:-=+*#%@";
+  const long cols = 64;
+  const long maxrows = 256;
+  long group = (map.blocks + cols * maxrows - 1) / (cols * maxrows);
+  group = group > 0 ? group : 1;
+
+  a_printf("Blocks of %li bytes, ' ' is 0 and '@' is 8 bits per byte.\n",
+           blocksize);
+  if (group > 1) {
+    a_printf("Warning: one cell per %li blocks, highest entropy shown.\n",
+             group);
+  }
+
+  long high = 0;
+  long lo = 0, hi = 0;
+  char line[64 + 1];
+  long cells = (map.blocks + group - 1) / group;
+
+  for (long c = 0; c < cells; c++) {
+    float e = 0;
+    for (long b = c * group; b < (c + 1) * group && b < map.blocks; b++)
+      e = map.entropy[b] > e ? map.entropy[b] : e;
+
+    long level = e * 10 / 8;
+    line[c % cols] = levels[level < 9 ? level : 9];
+
+    if (c % cols == cols - 1 || c == cells - 1) {
+      line[c % cols + 1] = '\0';
+      a_printf("%016lx|%s\n", pos + (c - c % cols) * group * blocksize, line);
+    }
+  }
+
+  for (long b = 0; b < map.blocks; b++) {
+    high += map.entropy[b] > 7.5;
+    lo = map.entropy[b] < map.entropy[lo] ? b : lo;
+    hi = map.entropy[b] > map.entropy[hi] ? b : hi;
+  }
+
+  if (map.blocks > 0) {
+    a_printf("min %.3f @ %016lx, max %.3f @ %016lx\n", map.entropy[lo],
+             pos + lo * blocksize, map.entropy[hi], pos + hi * blocksize);
+  }
+  a_printf("overall %.3f bits per byte, %li of %li blocks above 7.5\n",
+           q_entropy(map.total), high, map.blocks);
+
+  q_free(&map);
+  return he_ok;
+}
+
+int h_chunks(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 1 && args->argc != 2) {
+    a_puts("Expected 1 or 2 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  long avg = 1 << 13;
+  if (args->argc == 2) {
+    err = a_arg2long(args->argv[1], &avg);
+    check_he(err, { a_printf("Failed to parse size; error code %i.\n", err); });
+  }
+
+  cc_t chunker;
+  err = c_init(&chunker, avg);
+  check_he(err, {
+    a_puts("Average size must be a power of 2 from 256 to 16M.");
+  });
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  cl_t list;
+  err = c_stream(&ha->hex->stream, &chunker, pos, size - pos, &list);
+  check_he(err, {
+    a_printf("Failed to chunk stream; error code %i.\n", err);
+    c_free(&list);
+  });
+
+  const long maxrows = 256;
+  long shown = list.num < maxrows ? list.num : maxrows;
+  a_puts(".....offset.....|....size|..fingerprint...");
+  for (long i = 0; i < shown; i++) {
+    ck_t *chunk = &list.chunks[i];
+    a_printf("%016lx|%8li|%016lx\n", chunk->offset, chunk->size,
+             chunk->fingerprint);
+  }
+
+  if (list.num > shown) {
+    a_printf("Warning: display limited to %li of %li chunks.\n",
+             shown, list.num);
+  }
+
+  cs_t stats;
+  c_stats(&list, &stats);
+  a_printf("%li chunks, min %li, max %li, mean %.1f, stddev %.1f\n", stats.num,
+           stats.min, stats.max, stats.mean, stats.stddev);
+
+  for (int b = 0; b < 64; b++) {
+    if (stats.buckets[b] > 0)
+      a_printf("%10li-%-10li|%li\n", 1L << b, (2L << b) - 1, stats.buckets[b]);
+  }
+
+  if (stats.unique > 0) {
+    a_printf("%li distinct chunks, %li of %li bytes unique, ratio %.3f\n",
+             stats.distinct, stats.unique, stats.total,
+             (double)stats.total / stats.unique);
+  }
+
+  c_free(&list);
+  return he_ok;
+}
+
+int h_dupes(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 2 && args->argc != 3) {
+    a_puts("Expected 2 or 3 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  int cdc = strcmp(args->argv[1], "cdc") == 0;
+  if (!cdc && strcmp(args->argv[1], "fixed") != 0) {
+    a_puts("Expected fixed or cdc.");
+    return he_argc;
+  }
+
+  long size = cdc ? 1 << 13 : 1 << 12;
+  if (args->argc == 3) {
+    err = a_arg2long(args->argv[2], &size);
+    check_he(err, { a_printf("Failed to parse size; error code %i.\n", err); });
+  }
+
+  long pos, end;
+  err = h_pos_size(&ha->hex->stream, &pos, &end);
+  check_he(err, {});
+
+  cl_t list;
+  cc_t chunker;
+  if (cdc) {
+    err = c_init(&chunker, size);
+    check_he(err, {
+      a_puts("Average size must be a power of 2 from 256 to 16M.");
+    });
+    err = c_stream(&ha->hex->stream, &chunker, pos, end - pos, &list);
+  } else {
+    err = c_fixed(&ha->hex->stream, pos, end - pos, size, &list);
+    if (err == ce_size) {
+      a_puts("Block size must be from 1 to 16M.");
+      return err;
+    }
+  }
+
+  check_he(err, {
+    a_printf("Failed to fingerprint blocks; error code %i.\n", err);
+    c_free(&list);
+  });
+
+  cd_t dupes;
+  err = c_dupes(&list, &dupes);
+  check_he(err, {
+    a_puts("Too many blocks.");
+    c_free(&list);
+  });
+
+  const long maxrows = 256;
+  const long maxoffsets = 4;
+  long shown = dupes.num < maxrows ? dupes.num : maxrows;
+  long duplicates = 0;
+
+  a_puts("....size|..count|.....wasted|offsets");
+  for (long g = 0; g < dupes.num; g++) {
+    cg_t *group = &dupes.groups[g];
+    duplicates += group->count - 1;
+    if (g >= shown)
+      continue;
+
+    a_printf("%8li|%7u|%11li|", group->size, group->count,
+             group->size * (group->count - 1));
+
+    uint32_t i = group->first;
+    for (long n = 0; n < maxoffsets && i != UINT32_MAX; n++) {
+      a_printf("%s%016lx", n > 0 ? " " : "", list.chunks[i].offset);
+      i = dupes.next[i];
+    }
+
+    if (group->count > maxoffsets)
+      a_printf(" (+%li)", (long)group->count - maxoffsets);
+    a_printf("\n");
+  }
+
+  if (dupes.num > shown) {
+    a_printf("Warning: display limited to %li of %li groups.\n", shown,
+             dupes.num);
+  }
+
+  a_printf("%li groups, %li duplicate blocks of %li, %li bytes wasted\n",
+           dupes.num, duplicates, list.num, dupes.wasted);
+
+  c_freedupes(&dupes);
+  c_free(&list);
+  return he_ok;
+}
+
+int h_delta(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 2 && args->argc != 3) {
+    a_puts("Expected 2 or 3 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  long blocksize = 1 << 10;
+  if (args->argc == 3) {
+    err = a_arg2long(args->argv[2], &blocksize);
+    check_he(err, { a_printf("Failed to parse size; error code %i.\n", err); });
+  }
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  stream_t other;
+  err = s_openfile(&other, args->argv[1], sm_binary_read);
+  check_he(err, { a_printf("Failed to open file; error code %i.\n", err); });
+
+  cy_t sig;
+  err = c_sign(&other, blocksize, &sig);
+  s_close(&other);
+  check_he(err, {
+    a_printf("Failed to sign file; error code %i.\n", err);
+    c_freesign(&sig);
+  });
+
+  cv_t delta;
+  err = c_delta(&ha->hex->stream, pos, size - pos, &sig, &delta);
+  c_freesign(&sig);
+  check_he(err, {
+    a_printf("Failed to compute delta; error code %i.\n", err);
+    c_freedelta(&delta);
+  });
+
+  const long maxrows = 256;
+  long shown = delta.num < maxrows ? delta.num : maxrows;
+  a_puts(".....offset.....|.......size|.....source.....");
+  for (long i = 0; i < shown; i++) {
+    cp_t *span = &delta.spans[i];
+    if (span->source < 0)
+      a_printf("%016lx|%11li|insert\n", span->offset, span->size);
+    else
+      a_printf("%016lx|%11li|%016lx\n", span->offset, span->size, span->source);
+  }
+
+  if (delta.num > shown) {
+    a_printf("Warning: display limited to %li of %li spans.\n", shown,
+             delta.num);
+  }
+
+  a_printf("%li bytes copied, %li bytes inserted, %li spans\n", delta.copied,
+           delta.inserted, delta.num);
+
+  c_freedelta(&delta);
+  return he_ok;
+}
+
+int h_fuzzy(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+  int score;
+
+  if (args->argc < 1 || args->argc > 3) {
+    a_puts("Expected 1 to 3 arguments.");
+    return he_argc;
+  }
+
+  // two digests are compared without a stream
+  if (args->argc == 3) {
+    score = d_fuzzycompare(args->argv[1], args->argv[2]);
+    if (score < 0) {
+      a_puts("Malformed digest.");
+      return he_number;
+    }
+
+    a_printf("score %i\n", score);
+    return he_ok;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  char digest[D_FUZZYLEN];
+  err = d_fuzzystream(&ha->hex->stream, digest);
+  check_he(err, { a_printf("Failed to hash stream; error code %i.\n", err); });
+  a_printf("%s\n", digest);
+
+  if (args->argc == 2) {
+    score = d_fuzzycompare(digest, args->argv[1]);
+    if (score < 0) {
+      a_puts("Malformed digest.");
+      return he_number;
+    }
+
+    a_printf("score %i\n", score);
+  }
+
+  return he_ok;
+}
+
+int h_runs(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 1 && args->argc != 2) {
+    a_puts("Expected 1 or 2 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  long minlen = 16;
+  if (args->argc == 2) {
+    err = a_arg2long(args->argv[1], &minlen);
+    check_he(err, {
+      a_printf("Failed to parse length; error code %i.\n", err);
+    });
+  }
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  fl_t list;
+  err = f_runs(&ha->hex->stream, pos, size - pos, minlen, &list);
+  check_he(err, {
+    a_printf("Failed to find runs; error code %i.\n", err);
+    f_free(&list);
+  });
+
+  const long maxrows = 256;
+  long shown = list.num < maxrows ? list.num : maxrows;
+  long total = 0;
+  a_puts(".....offset.....|.......size|byte");
+  for (long i = 0; i < list.num; i++) {
+    fr_t *run = &list.runs[i];
+    total += run->size;
+    if (i < shown)
+      a_printf("%016lx|%11li|  %02X\n", run->offset, run->size, run->byte);
+  }
+
+  if (list.num > shown) {
+    a_printf("Warning: display limited to %li of %li runs.\n", shown, list.num);
+  }
+
+  // fill map: 64 cells per row, 256 rows at most, cells of 4 KiB or more
+  const long cols = 64;
+  long cell = 1 << 12;
+  while (cell * cols * maxrows < size - pos)
+    cell *= 2;
+
+  long cells = (size - pos + cell - 1) / cell;
+  long *zero = calloc(cells + 1, sizeof(long));
+  long *erased = calloc(cells + 1, sizeof(long));
+  assert(zero != NULL && erased != NULL);
+  long zeros = 0, ffs = 0;
+
+  for (long i = 0; i < list.num; i++) {
+    fr_t *run = &list.runs[i];
+    if (run->byte != 0x00 && run->byte != 0xFF)
+      continue;
+
+    long *fill = run->byte == 0x00 ? zero : erased;
+    *(run->byte == 0x00 ? &zeros : &ffs) += run->size;
+    long start = run->offset - pos;
+    long end = start + run->size;
+    for (long c = start / cell; c * cell < end; c++) {
+      long from = c * cell > start ? c * cell : start;
+      long to = (c + 1) * cell < end ? (c + 1) * cell : end;
+      fill[c] += to - from;
+    }
+  }
+
+  a_printf("Cells of %li bytes: '0' or 'F' mostly 00 or FF, '.' partly, "
+           "'#' none.\n", cell);
+  char line[64 + 1];
+  for (long c = 0; c < cells; c++) {
+    long bytes = (c + 1) * cell < size - pos ? cell : size - pos - c * cell;
+    long filled = zero[c] + erased[c];
+    char ch = filled == 0 ? '#' : '.';
+    if (2 * filled >= bytes)
+      ch = zero[c] >= erased[c] ? '0' : 'F';
+    line[c % cols] = ch;
+
+    if (c % cols == cols - 1 || c == cells - 1) {
+      line[c % cols + 1] = '\0';
+      a_printf("%016lx|%s\n", pos + (c - c % cols) * cell, line);
+    }
+  }
+
+  a_printf("%li runs, %li bytes; %li bytes of 00, %li bytes of FF\n", list.num,
+           total, zeros, ffs);
+
+  free(zero);
+  free(erased);
+  f_free(&list);
+  return he_ok;
+}
+
+int h_ngrams(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 3, &ha);
+  check_he(err, {});
+
+  long n, k;
+  err = a_arg2long(args->argv[1], &n);
+  check_he(err, { a_printf("Failed to parse n; error code %i.\n", err); });
+
+  err = a_arg2long(args->argv[2], &k);
+  check_he(err, { a_printf("Failed to parse k; error code %i.\n", err); });
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  qn_t top;
+  err = q_ngraminit(&top, n, k);
+  check_he(err, { a_puts("Expected n from 1 to 8 and k from 1 to 4096."); });
+
+  err = q_ngramstream(&ha->hex->stream, pos, size - pos, &top);
+  check_he(err, {
+    a_printf("Failed to count n-grams; error code %i.\n", err);
+    q_ngramfree(&top);
+  });
+
+  qg_t *grams = malloc(sizeof(qg_t) * k);
+  assert(grams != NULL);
+  long num = q_ngramtop(&top, grams);
+
+  a_puts("rank|gram............|ascii...|.........count|.....%");
+  for (long i = 0; i < num; i++) {
+    char hex[17], ascii[9];
+    for (long b = 0; b < n; b++) {
+      uint8_t byte = grams[i].gram >> (8 * (n - 1 - b));
+      sprintf(hex + 2 * b, "%02X", byte);
+      ascii[b] = isprint(byte) ? byte : '.';
+    }
+    ascii[n] = '\0';
+
+    a_printf("%4li|%-16s|%-8s|%14lu|%6.2f\n", i + 1, hex, ascii,
+             grams[i].count, 100.0 * grams[i].count / top.total);
+  }
+
+  // count-min error bound: e * N / width with probability 1 - e^-depth
+  a_printf("%lu %li-grams, counts may be overestimated by up to %.0f\n",
+           top.total, n, 2.718281828 * top.total / (1L << Q_WIDTHBITS));
+
+  free(grams);
+  q_ngramfree(&top);
+  return he_ok;
+}
+
+int h_findval(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 3 && args->argc != 4) {
+    a_puts("Expected 2 or 3 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  fv_t value;
+  err = f_value(args->argv[1], args->argv[2], &value);
+  check_he(err, {
+    if (err == fe_type)
+      a_puts("Expected a type u16, i32, f64, etc., with an optional le or be.");
+    else
+      a_printf("Failed to parse value; error code %i.\n", err);
+  });
+
+  long align = 1;
+  if (args->argc == 4) {
+    err = a_arg2long(args->argv[3], &align);
+    check_he(err, {
+      a_printf("Failed to parse alignment; error code %i.\n", err);
+    });
+  }
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  const long maxrows = 256;
+  fk_t list;
+  err = f_findval(&ha->hex->stream, pos, size - pos, &value, align, maxrows,
+                  ha->maxhits, &list);
+  check_he(err, {
+    a_printf("Failed to find value; error code %i.\n", err);
+    f_freehits(&list);
+  });
+
+  cstr orders[] = {"le", "be", "le/be"};
+  a_puts(".....offset.....|order");
+  for (long i = 0; i < list.num; i++) {
+    a_printf("%016lx|%s\n", list.hits[i].offset, orders[list.hits[i].order]);
+  }
+
+  if (list.total > list.num) {
+    a_printf("Warning: display limited to %li of %li matches.\n", list.num,
+             list.total);
+  }
+
+  a_printf("%li matches.\n", list.total);
+  if (list.offsets.full) {
+    a_printf("Warning: only the first %li offsets are kept for {}.\n",
+             list.offsets.num);
+  }
+
+  f_freeoffsets(&ha->hex->hits);
+  ha->hex->hits = list.offsets;
+  list.offsets = (fp_t){0};
+
+  f_freehits(&list);
+  return he_ok;
+}
+
+int h_findxor(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 2 && args->argc != 3) {
+    a_puts("Expected 1 or 2 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  long size;
+  uint8_t *pattern = malloc(strlen(args->argv[1]) / 2 + 1);
+  assert(pattern != NULL);
+  err = h_hexbytes(args->argv[1], pattern, &size);
+  check_he(err, { free(pattern); });
+
+  long keylen = 1;
+  if (args->argc == 3) {
+    err = a_arg2long(args->argv[2], &keylen);
+    check_he(err, {
+      a_printf("Failed to parse key length; error code %i.\n", err);
+      free(pattern);
+    });
+  }
+
+  long pos, end;
+  err = h_pos_size(&ha->hex->stream, &pos, &end);
+  check_he(err, { free(pattern); });
+
+  const long maxrows = 256;
+  fq_t list;
+  err = f_findxor(&ha->hex->stream, pos, end - pos, pattern, size, keylen,
+                  maxrows, ha->maxhits, &list);
+  free(pattern);
+  check_he(err, {
+    if (err == fe_size)
+      a_puts("Expected a key length from 1 to 8, shorter than the pattern.");
+    else
+      a_printf("Failed to find pattern; error code %i.\n", err);
+    f_freexor(&list);
+  });
+
+  a_puts(".....offset.....|key");
+  for (long i = 0; i < list.num; i++) {
+    char key[17];
+    for (long k = 0; k < keylen; k++)
+      sprintf(key + 2 * k, "%02X", list.hits[i].key[k]);
+    a_printf("%016lx|%s\n", list.hits[i].offset, key);
+  }
+
+  if (list.total > list.num) {
+    a_printf("Warning: display limited to %li of %li matches.\n", list.num,
+             list.total);
+  }
+
+  a_printf("%li matches.\n", list.total);
+  if (list.offsets.full) {
+    a_printf("Warning: only the first %li offsets are kept for {}.\n",
+             list.offsets.num);
+  }
+
+  f_freeoffsets(&ha->hex->hits);
+  ha->hex->hits = list.offsets;
+  list.offsets = (fp_t){0};
+
+  f_freexor(&list);
+  return he_ok;
+}
+
+int h_findbits(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 2, &ha);
+  check_he(err, {});
+
+  cstr digits = args->argv[1];
+  long nbits = strlen(digits);
+  uint64_t bits = 0;
+  for (long i = 0; i < nbits; i++) {
+    if (digits[i] != '0' && digits[i] != '1') {
+      a_printf("Invalid digit @ pos %li (%c)\n", i, digits[i]);
+      return he_number;
+    }
+    bits = bits << 1 | (digits[i] - '0');
+  }
+
+  long pos, size;
+  err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {});
+
+  const long maxrows = 256;
+  fs_t list;
+  err = f_findbits(&ha->hex->stream, pos, size - pos, bits, nbits, maxrows,
+                   ha->maxhits, &list);
+  check_he(err, {
+    if (err == fe_size)
+      a_puts("Expected 1 to 64 bits.");
+    else
+      a_printf("Failed to find bits; error code %i.\n", err);
+    f_freebits(&list);
+  });
+
+  a_puts(".....offset.....:bit");
+  for (long i = 0; i < list.num; i++) {
+    a_printf("%016lx:%i\n", list.hits[i].offset, list.hits[i].bit);
+  }
+
+  if (list.total > list.num) {
+    a_printf("Warning: display limited to %li of %li matches.\n", list.num,
+             list.total);
+  }
+
+  a_printf("%li matches.\n", list.total);
+  if (list.offsets.full) {
+    a_printf("Warning: only the first %li offsets are kept for {}.\n",
+             list.offsets.num);
+  }
+
+  f_freeoffsets(&ha->hex->hits);
+  ha->hex->hits = list.offsets;
+  list.offsets = (fp_t){0};
+
+  f_freebits(&list);
+  return he_ok;
+}
+
+/*
+ * Overwrite or insert the hex bytes of the 1st argument at the position
+ */
+static int h_edit(app_t *app, ha_t *args, int insert) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 2, &ha);
+  check_he(err, {});
+
+  long size;
+  uint8_t *bytes = malloc(strlen(args->argv[1]) / 2 + 1);
+  assert(bytes != NULL);
+  err = h_hexbytes(args->argv[1], bytes, &size);
+  check_he(err, { free(bytes); });
+
+  err = h_editable(ha->hex);
+  check_he(err, {
+    a_printf("Failed to edit; error code %i.\n", err);
+    free(bytes);
+  });
+
+  long pos;
+  s_pos(&ha->hex->stream, &pos);
+  if (insert)
+    err = e_insert(&ha->hex->edit, pos, bytes, size);
+  else
+    err = e_overwrite(&ha->hex->edit, pos, bytes, size);
+
+  free(bytes);
+  h_edited(ha->hex, pos);
+  check_he(err, { a_printf("Failed to edit; error code %i.\n", err); });
+
+  a_printf("%li bytes %s @ %li, %li pieces.\n", size,
+           insert ? "inserted" : "overwritten", pos, ha->hex->edit.pieces);
+  return he_ok;
+}
+
+int h_overwrite(app_t *app, ha_t *args) { return h_edit(app, args, 0); }
+
+int h_insert(app_t *app, ha_t *args) { return h_edit(app, args, 1); }
+
+int h_delete(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 2, &ha);
+  check_he(err, {});
+
+  long size;
+  err = a_arg2long(args->argv[1], &size);
+  check_he(err, { a_printf("Failed to parse length; error code %i.\n", err); });
+
+  err = h_editable(ha->hex);
+  check_he(err, { a_printf("Failed to edit; error code %i.\n", err); });
+
+  long pos;
+  s_pos(&ha->hex->stream, &pos);
+  err = e_delete(&ha->hex->edit, pos, size);
+  h_edited(ha->hex, pos);
+  check_he(err, { a_printf("Failed to delete; error code %i.\n", err); });
+
+  a_printf("%li bytes deleted @ %li, %li pieces.\n", size, pos,
+           ha->hex->edit.pieces);
+  return he_ok;
+}
+
+int h_replace(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 3 && args->argc != 4) {
+    a_puts("Expected 2 or 3 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  long fsize, rsize;
+  uint8_t *find = malloc(strlen(args->argv[1]) / 2 + 1);
+  uint8_t *with = malloc(strlen(args->argv[2]) / 2 + 1);
+  assert(find != NULL && with != NULL);
+  err = h_hexbytes(args->argv[1], find, &fsize);
+  if (err == he_ok)
+    err = h_hexbytes(args->argv[2], with, &rsize);
+
+  long range = 0;
+  if (err == he_ok && args->argc == 4) {
+    err = a_arg2long(args->argv[3], &range);
+    if (err != he_ok)
+      a_printf("Failed to parse range; error code %i.\n", err);
+  }
+
+  long pos, size;
+  if (err == he_ok)
+    err = h_pos_size(&ha->hex->stream, &pos, &size);
+  check_he(err, {
+    free(find);
+    free(with);
+  });
+
+  if (range <= 0 || pos + range > size)
+    range = size - pos;
+
+  // the edited content is read in blocks while it is replaced, all of the
+  // occurrences one edit for undo
+  long count = 0;
+  err = h_editable(ha->hex);
+  if (err == ee_ok)
+    err = e_replaceall(&ha->hex->edit, pos, range, find, fsize, with, rsize,
+                       &count);
+
+  free(find);
+  free(with);
+  if (ha->hex->edit.original != NULL)
+    h_edited(ha->hex, pos);
+  check_he(err, { a_printf("Failed to replace; error code %i.\n", err); });
+
+  a_printf("%li occurrences replaced, %s.\n", count,
+           fsize == rsize ? "in place when saved" : "moving the bytes after");
+  return he_ok;
+}
+
+/*
+ * Undo or redo an edit and move to where it was
+ */
+static int h_history(app_t *app, ha_t *args, int redo) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 1, &ha);
+  check_he(err, {});
+
+  long where;
+  err = ha->hex->edit.original == NULL ? ee_range
+        : redo                        ? e_redo(&ha->hex->edit, &where)
+                                      : e_undo(&ha->hex->edit, &where);
+  check_he(err, { a_printf("Nothing to %s.\n", redo ? "redo" : "undo"); });
+
+  // a group of edits, as those of a replace, counts as one
+  h_edited(ha->hex, where);
+  ej_t *h = &ha->hex->edit.history;
+  long done = h->done > 0 ? h->edits[h->done - 1].group : 0;
+  long num = h->num > 0 ? h->edits[h->num - 1].group : 0;
+  a_printf("%s edit @ %li, %li of %li edits applied.\n",
+           redo ? "Redid" : "Undid", where, done, num);
+  return he_ok;
+}
+
+int h_undo(app_t *app, ha_t *args) { return h_history(app, args, 0); }
+
+int h_redo(app_t *app, ha_t *args) { return h_history(app, args, 1); }
+
+int h_save(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 1, &ha);
+  check_he(err, {});
+
+  if (ha->hex->edit.original == NULL) {
+    a_puts("Nothing to save.");
+    return he_ok;
+  }
+
+  char *path;
+  p_string(&ha->hex->path, &path);
+
+  es_t saved;
+  err = e_save(&ha->hex->edit, path, &saved);
+  check_he(err, { a_printf("Failed to save; error code %i.\n", err); });
+
+  // the file holds the edits now: start over from it
+  err = h_reopen(ha->hex, path);
+  check_he(err, {});
+
+  if (saved.inplace)
+    a_printf("Saved in place, %li bytes written.\n", saved.written);
+  else
+    a_printf("Saved, %li bytes written and %li copied.\n", saved.written,
+             saved.copied);
+  return he_ok;
+}
+
+int h_patch(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  err = h_check(app, args, 3, &ha);
+  check_he(err, {});
+
+  char *path;
+  p_string(&ha->hex->path, &path);
+  et_t *edit = &ha->hex->edit;
+  long size;
+
+  if (strcmp(args->argv[1], "export") == 0) {
+    if (edit->original == NULL || edit->history.done == 0) {
+      a_puts("Nothing to export.");
+      return he_ok;
+    }
+
+    err = e_export(edit, args->argv[2], &size);
+    check_he(err, { a_printf("Failed to export; error code %i.\n", err); });
+    a_printf("Patch of %li bytes written to '%s'.\n", size, args->argv[2]);
+    return he_ok;
+  }
+
+  if (strcmp(args->argv[1], "apply") != 0) {
+    a_puts("Expected export or apply.");
+    return he_argc;
+  }
+
+  if (edit->original != NULL && edit->history.done > 0) {
+    a_puts("Save or undo the edits first.");
+    return he_state;
+  }
+
+  err = e_apply(args->argv[2], path, &size);
+  check_he(err, {
+    if (err == ee_source)
+      a_puts("The patch is for another file.");
+    else if (err == ee_patch)
+      a_puts("The patch is damaged.");
+    else
+      a_printf("Failed to apply; error code %i.\n", err);
+  });
+
+  err = h_reopen(ha->hex, path);
+  check_he(err, {});
+  a_printf("Patch applied, the file is now %li bytes.\n", size);
+  return he_ok;
+}
+
+int h_files(app_t *app, ha_t *args) {
+  assert(app != NULL);
+  assert(args != NULL);
+  hexapp_t *ha = (hexapp_t *)app;
+
+  check_args(args->argc, 1, { a_puts("Expected 1 argument."); });
+
+  long open = 0;
+  a_puts("...#|......size......|path");
+  for (long i = 0; i < ha->files.num; i++) {
+    hex_t *hex = ha->files.slots[i];
+    if (hex->state == hs_ready)
+      continue;
+
+    // a parked file is not opened to be listed
+    char *path;
+    p_string(&hex->path, &path);
+    struct stat st;
+    long size = hex->state == hs_occupied ? hex->stream.size
+                : stat(path, &st) == 0    ? st.st_size
+                                          : -1;
+    a_printf("%c%3li|%18li|%s%s%s\n", hex == ha->hex ? '*' : ' ', i + 1, size,
+             path, hex->state == hs_parked ? " (parked)" : "",
+             hex->edit.history.done > 0 ? " (edited)" : "");
+    open++;
+  }
+
+  a_printf("%li files open.\n", open);
+  return he_ok;
+}
+
+int h_use(app_t *app, ha_t *args) {
+  assert(app != NULL);
+  assert(args != NULL);
+  hexapp_t *ha = (hexapp_t *)app;
+  int err;
+
+  if (args->argc < 2) {
+    a_puts("Expected 1 argument or more.");
+    return he_argc;
+  }
+
+  long number;
+  err = a_arg2long(args->argv[1], &number);
+  check_he(err, { a_printf("Failed to parse number; error code %i.\n", err); });
+
+  if (number < 1 || number > ha->files.num ||
+      ha->files.slots[number - 1]->state == hs_ready) {
+    a_printf("No file #%li.\n", number);
+    return he_state;
+  }
+
+  hex_t *previous = ha->hex;
+  hex_t *hex = ha->files.slots[number - 1];
+  err = h_resident(ha, hex);
+  check_he(err, {});
+  ha->hex = hex;
+
+  if (args->argc == 2) {
+    char *path;
+    p_string(&hex->path, &path);
+    a_printf("Using #%li, %s.\n", number, path);
+    return he_ok;
+  }
+
+  // the rest of the arguments is one command on that file only
+  aa_t command = {.argc = args->argc - 2, .argv = args->argv + 2};
+  a_dispatch(app, command.argv[0], app->cmdbuf, app->cmdnum, &command);
+  err = app->result;
+
+  if (previous->state == hs_parked)
+    h_resident(ha, previous);
+  ha->hex = previous;
+  return err;
+}
+
+int h_hits(app_t *app, ha_t *args) {
+  assert(app != NULL);
+  assert(args != NULL);
+  hexapp_t *ha = (hexapp_t *)app;
+  int err;
+
+  check_args(args->argc, 2, { a_puts("Expected 2 arguments."); });
+
+  long max;
+  err = a_arg2long(args->argv[1], &max);
+  check_he(err, { a_printf("Failed to parse number; error code %i.\n", err); });
+
+  if (max < 1) {
+    a_puts("Expected 1 offset or more.");
+    return he_size;
+  }
+
+  ha->maxhits = max;
+  a_printf("Searches keep up to %li offsets for {}.\n", max);
+  return he_ok;
+}
+
+int h_extract(app_t *app, ha_t *args) {
+  int err;
+  hexapp_t *ha;
+
+  if (args->argc != 3 && args->argc != 4) {
+    a_puts("Expected 2 or 3 arguments.");
+    return he_argc;
+  }
+
+  err = h_check(app, args, args->argc, &ha);
+  check_he(err, {});
+
+  long one, *offsets, num, size;
+  err = h_offsets(ha->hex, args->argv[1], &one, &offsets, &num);
+  check_he(err, {});
+
+  err = a_arg2long(args->argv[2], &size);
+  check_he(err, { a_printf("Failed to parse size; error code %i.\n", err); });
+
+  // "{}" in the path stands for the offset, in hexadecimal
+  cstr path = args->argc == 4 ? args->argv[3] : "{}.bin";
+  cstr mark = strstr(path, "{}");
+  if (mark == NULL && num > 1) {
+    a_puts("Expected {} in the path, to extract to one file per offset.");
+    return he_argc;
+  }
+
+  const long block = 1 << 20;
+  const long maxrows = 256;
+  uint8_t *buf = malloc(block);
+  assert(buf != NULL);
+
+  for (long i = 0; i < num; i++) {
+    if (size < 0 || offsets[i] < 0 ||
+        offsets[i] + size > ha->hex->stream.size) {
+      a_puts("Range is outside of the stream.");
+      free(buf);
+      return he_size;
+    }
+
+    char name[PATH_MAX];
+    if (mark != NULL)
+      snprintf(name, sizeof(name), "%.*s%016lx%s", (int)(mark - path), path,
+               offsets[i], mark + 2);
+    else
+      snprintf(name, sizeof(name), "%s", path);
+
+    FILE *file = fopen(name, "wb");
+    if (file == NULL) {
+      a_printf("Failed to create '%s'.\n", name);
+      free(buf);
+      return he_read;
+    }
+
+    for (long done = 0; done < size && err == he_ok;) {
+      long n = size - done < block ? size - done : block;
+      sb_t mem = {.data = buf, .size = n};
+      long read = 0;
+      if (s_readat(&ha->hex->stream, &mem, offsets[i] + done, &read) != se_ok ||
+          read != n || (long)fwrite(buf, 1, n, file) != n)
+        err = he_read;
+      done += n;
+    }
+
+    fclose(file);
+    check_he(err, {
+      a_printf("Failed to extract to '%s'.\n", name);
+      free(buf);
+    });
+
+    if (i < maxrows)
+      a_printf("%li bytes @ %016lx written to '%s'.\n", size, offsets[i], name);
+  }
+
+  if (num > maxrows)
+    a_printf("Warning: display limited to %li of %li files.\n", maxrows, num);
+
+  a_printf("%li files written.\n", num);
+  free(buf);
+  return he_ok;
+}
+
+int h_findimg(app_t *app, ha_t *args);
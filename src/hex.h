@@ -5,9 +5,20 @@
 #pragma once
 
 #include <ctype.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "app.h"
+#include "chunk.h"
+#include "digest.h"
+#include "edit.h"
+#include "find.h"
+#include "freq.h"
 #include "path.h"
+#include "record.h"
+#include "vector.h"
 
 /*******************************************************************************
  *                            Hex object definitions
@@ -24,14 +35,9 @@ typedef aa_t ha_t;
 typedef int8_t h16_t[16];
 
 /*
- * 3 bytes string for 1 hex formatted byte
+ * 16 bytes string for 1 preformatted cell
  */
-typedef int8_t h3_t[3];
-
-/*
- * 42 bytes string for 16 consecutive hex formatted bytes.
- */
-typedef int8_t h42_t[16 * 3];
+typedef char hc16_t[16];
 
 /*
  * Hex error codes
@@ -41,36 +47,95 @@ typedef enum { he_ok, he_argc, he_state, he_number, he_read, he_size } he_t;
 /*
  * Hex program states
  */
-typedef enum { hs_ready, hs_occupied } hs_t;
+typedef enum { hs_ready, hs_occupied, hs_parked } hs_t;
+
+/*
+ * Hex cell table, one cell per byte value plus one empty cell
+ */
+typedef struct {
+  hc16_t hex[257];
+  hc16_t ascii[257];
+  long hexsz;
+  long asciisz;
+} hc_t;
 
 /*
  * Hex byte row
  */
 typedef struct {
-  h16_t ascii;
-  int64_t zero;
-  union {
-    h3_t hex[16];
-    h42_t allhex;
-  };
-  int64_t zero1;
+  h16_t bytes;
+  char text[16 * 2 * sizeof(hc16_t) + 1];
 } hr_t;
 
 /*
- * Hex object
+ * Hex range of differing bytes
+ */
+typedef struct {
+  long start;
+  long end;
+} hd_t;
+
+/*
+ * Hex object, one per open file. A parked file has its stream and its read
+ * buffer freed and keeps where it was in `pos`; `used` orders the files by
+ * last use. `dev` and `ino` tell the file apart whatever path names it,
+ * `opened` when it was opened in its slot, and `edits` counts the edits
+ * made to it.
  */
 typedef struct {
   path_t path;
   stream_t stream;
+  stream_t file;
+  et_t edit;
+  fp_t hits;
   hs_t state;
+  int color;
+  char *buffer;
+  long pos;
+  long used;
+  dev_t dev;
+  ino_t ino;
+  long opened;
+  long edits;
 } hex_t;
 
 /*
- * Hex app object
+ * Open files, numbered from 1 by slot. The read buffers of the files not
+ * parked share `budget` bytes, H_BUFFER each.
+ */
+typedef struct {
+  hex_t **slots;
+  long num;
+  long alloc;
+  long budget;
+  long tick;
+} hf_t;
+
+/*
+ * Default memory shared by the read buffers, and the buffer of one file
+ */
+#define H_BUDGET (64L << 20)
+#define H_BUFFER (256L << 10)
+
+/*
+ * Default number of offsets a search keeps for `{}` (32 MiB of them)
+ */
+#define H_MAXHITS (1L << 22)
+
+/*
+ * Most commands the server runs at once on worker threads
+ */
+#define H_JOBS 32
+
+/*
+ * Hex app object, `hex` being the file commands apply to, a search keeping
+ * `maxhits` offsets at most
  */
 typedef struct {
   app_t app;
-  hex_t hex;
+  hex_t *hex;
+  hf_t files;
+  long maxhits;
 } hexapp_t;
 
 /*******************************************************************************
@@ -88,12 +153,18 @@ int h_init(hexapp_t *app);
 void h_deinit(hexapp_t *app);
 
 /*
- * Open file
+ * Serve the commands to the clients of a Unix socket at `path`, until
+ * SIGINT or SIGTERM. Files stay open between clients.
+ */
+int h_serve(hexapp_t *app, cstr path);
+
+/*
+ * Open file, next to the files already open
  */
 int h_open(app_t *app, ha_t *args);
 
 /*
- * Close file
+ * Close the current file
  */
 int h_close(app_t *app, ha_t *args);
 
@@ -107,6 +178,11 @@ int h_move(app_t *app, ha_t *args);
  */
 int h_view(app_t *app, ha_t *args);
 
+/*
+ * Toggle colorized byte classes in viewer
+ */
+int h_color(app_t *app, ha_t *args);
+
 /*
  * Save file offset
  */
@@ -137,6 +213,131 @@ int h_find(app_t *app, ha_t *args);
  */
 int h_findx(app_t *app, ha_t *args);
 
+/*
+ * Compare stream with an other file
+ */
+int h_diff(app_t *app, ha_t *args);
+
+/*
+ * Decode an array of fixed-size records
+ */
+int h_table(app_t *app, ha_t *args);
+
+/*
+ * Hash a range of the stream
+ */
+int h_hash(app_t *app, ha_t *args);
+
+/*
+ * Map the entropy of fixed-size blocks
+ */
+int h_entropy(app_t *app, ha_t *args);
+
+/*
+ * Split the stream into content-defined chunks
+ */
+int h_chunks(app_t *app, ha_t *args);
+
+/*
+ * Find groups of identical blocks
+ */
+int h_dupes(app_t *app, ha_t *args);
+
+/*
+ * Express the stream as copies from an other file and insertions
+ */
+int h_delta(app_t *app, ha_t *args);
+
+/*
+ * Fuzzy digest of the stream, or similarity of two digests
+ */
+int h_fuzzy(app_t *app, ha_t *args);
+
+/*
+ * List runs of a repeated byte and map zero-filled regions
+ */
+int h_runs(app_t *app, ha_t *args);
+
+/*
+ * Most frequent n-byte sequences in bounded memory
+ */
+int h_ngrams(app_t *app, ha_t *args);
+
+/*
+ * Find an integer or float in both byte orders at once
+ */
+int h_findval(app_t *app, ha_t *args);
+
+/*
+ * Find a hex pattern XORed with any short repeating key
+ */
+int h_findxor(app_t *app, ha_t *args);
+
+/*
+ * Find a bit pattern at any bit offset
+ */
+int h_findbits(app_t *app, ha_t *args);
+
+/*
+ * Overwrite bytes at the stream position, without writing the file
+ */
+int h_overwrite(app_t *app, ha_t *args);
+
+/*
+ * Insert bytes at the stream position, without writing the file
+ */
+int h_insert(app_t *app, ha_t *args);
+
+/*
+ * Delete bytes at the stream position, without writing the file
+ */
+int h_delete(app_t *app, ha_t *args);
+
+/*
+ * Replace every occurrence of a hex pattern by an other
+ */
+int h_replace(app_t *app, ha_t *args);
+
+/*
+ * Undo the last edit
+ */
+int h_undo(app_t *app, ha_t *args);
+
+/*
+ * Redo the last edit undone
+ */
+int h_redo(app_t *app, ha_t *args);
+
+/*
+ * Write the edits to the file, recoverably
+ */
+int h_save(app_t *app, ha_t *args);
+
+/*
+ * Export the edits as a patch, or apply a patch to the file
+ */
+int h_patch(app_t *app, ha_t *args);
+
+/*
+ * List the open files
+ */
+int h_files(app_t *app, ha_t *args);
+
+/*
+ * Make an open file the one commands apply to, or run one command on it
+ */
+int h_use(app_t *app, ha_t *args);
+
+/*
+ * Set how many offsets a search keeps for "{}"
+ */
+int h_hits(app_t *app, ha_t *args);
+
+/*
+ * Write bytes at an offset, or at every offset piped in, to files
+ */
+int h_extract(app_t *app, ha_t *args);
+
 /*
  * Find images
  */
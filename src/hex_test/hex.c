@@ -2,6 +2,8 @@
  * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
  */
 
+#include <sys/wait.h>
+
 #include "../hex.h"
 #include "../test.h"
 
@@ -14,7 +16,7 @@
  *******************************************************************************/
 
 hexapp_t h_util_create_app(ad_t fn) {
-  hexapp_t app;
+  hexapp_t app = {0};
   static ac_t commands[1];
   commands[0] = a_command("test", "test", fn);
   ap_t ap = {
@@ -25,29 +27,106 @@ hexapp_t h_util_create_app(ad_t fn) {
   };
 
   a_init(&app.app, &ap);
-  app.hex.state = hs_ready;
+  app.hex = calloc(1, sizeof(hex_t));
+  app.files.slots = malloc(sizeof(hex_t *));
+  app.files.slots[0] = app.hex;
+  app.files.num = app.files.alloc = 1;
+  app.files.budget = H_BUDGET;
+  app.maxhits = H_MAXHITS;
+  app.hex->state = hs_ready;
   return app;
 }
 
-hexapp_t h_util_create_app_open_file(ad_t fn) {
+hexapp_t h_util_create_app_open(ad_t fn, cstr path) {
   stream_t stream;
   hexapp_t app;
   ps_t ps;
   int err;
 
   app = h_util_create_app(fn);
-  ps = p_literal("dump.sample");
-  err = s_openfile(&app.hex.stream, ps.chars, sm_binary_read);
+  ps = p_decayed(path);
+  err = s_openfile(&app.hex->stream, ps.chars, sm_binary_read);
   assert(err == se_ok);
-  p_init(&app.hex.path, &ps);
-  app.hex.state = hs_occupied;
+  p_init(&app.hex->path, &ps);
+  app.hex->state = hs_occupied;
 
   return app;
 }
 
+hexapp_t h_util_create_app_open_file(ad_t fn) {
+  return h_util_create_app_open(fn, "dump.sample");
+}
+
+/*
+ * Send stdout to a temporary file until h_util_captured
+ */
+int h_util_capture(FILE **tmp) {
+  fflush(stdout);
+  int saved = dup(STDOUT_FILENO);
+  *tmp = tmpfile();
+  assert(*tmp != NULL);
+  dup2(fileno(*tmp), STDOUT_FILENO);
+  return saved;
+}
+
+/*
+ * Restore stdout and get what was printed since h_util_capture
+ */
+str h_util_captured(FILE *tmp, int saved) {
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+
+  long size = ftell(tmp);
+  str out = calloc(size + 1, 1);
+  assert(out != NULL);
+  rewind(tmp);
+  fread(out, 1, size, tmp);
+  fclose(tmp);
+  return out;
+}
+
+/*
+ * Connect to a server, waiting for it to listen
+ */
+int h_util_connect(cstr path) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  strcpy(addr.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  while (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    usleep(1000);
+  return fd;
+}
+
+/*
+ * Read the reply of a server until `until` is in it, to the end if NULL
+ */
+void h_util_reply(int fd, str reply, long size, cstr until) {
+  long len = 0;
+  memset(reply, 0, size);
+  while (len < size - 1 && (until == NULL || strstr(reply, until) == NULL)) {
+    ssize_t got = read(fd, reply + len, size - 1 - len);
+    if (got <= 0)
+      break;
+    len += got;
+  }
+}
+
 void h_util_destroy_app(hexapp_t *app) {
   a_deinit(&app->app);
-  s_close(&app->hex.stream);
+  for (long i = 0; i < app->files.num; i++) {
+    hex_t *hex = app->files.slots[i];
+    if (hex->state == hs_occupied)
+      s_close(&hex->stream);
+    f_freeoffsets(&hex->hits);
+    if (hex->edit.original != NULL) {
+      e_free(&hex->edit);
+      s_close(&hex->file);
+    }
+    free(hex->buffer);
+    free(hex);
+  }
+  free(app->files.slots);
 }
 
 /*******************************************************************************
@@ -64,7 +143,7 @@ void h_test_open(void) {
   a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
 
   // assert
-  hs_t state = app.hex.state;
+  hs_t state = app.hex->state;
   int result = app.app.result;
   h_util_destroy_app(&app);
 
@@ -103,7 +182,7 @@ void h_test_close(void) {
   int result = app.app.result;
 
   t_exp("%i", he_ok, "%i", result, { h_util_destroy_app(&app); });
-  t_exp("%i", hs_ready, "%i", app.hex.state, { h_util_destroy_app(&app); });
+  t_exp("%i", hs_ready, "%i", app.hex->state, { h_util_destroy_app(&app); });
   t_ok();
 }
 
@@ -118,7 +197,7 @@ void h_test_move(void) {
 
   // assert
   int result = app.app.result;
-  long pos = ftell(app.hex.stream.handle);
+  long pos = ftell(app.hex->stream.handle);
   h_util_destroy_app(&app);
   t_exp("%i", he_ok, "%i", result, {});
   t_exp("%li", 200L, "%li", pos, {});
@@ -136,7 +215,7 @@ void h_test_move_somehow_works(void) {
 
   // assert
   int result = app.app.result;
-  long pos = ftell(app.hex.stream.handle);
+  long pos = ftell(app.hex->stream.handle);
   h_util_destroy_app(&app);
   t_exp("%i", he_ok, "%i", result, {});
   t_exp("%li", 0L, "%li", pos, {});
@@ -175,6 +254,92 @@ void h_test_view_failed(void) {
   t_ok();
 }
 
+void h_test_view_folded(void) {
+  // arrange
+  static int8_t zeros[256];
+  sb_t mem = s_array(zeros);
+  hexapp_t app = h_util_create_app(h_view);
+  s_openmem(&app.hex->stream, &mem, sm_binary_read);
+  app.hex->state = hs_occupied;
+  str args[] = {"test", "256"};
+  aa_t aa = {.argc = 2, .argv = args};
+
+  cstr row = "|00 00 00 00|00 00 00 00|00 00 00 00|00 00 00 00|"
+              "................\n";
+  char expected[256];
+  snprintf(expected, sizeof(expected), "%016x%s*\n%016x%s", 0, row, 0xF0, row);
+  FILE *tmp;
+
+  // act
+  int saved = h_util_capture(&tmp);
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  str output = h_util_captured(tmp, saved);
+
+  // assert
+  int result = app.app.result;
+  long pos = ftell(app.hex->stream.handle);
+  str rows = strchr(output, '\n') + 1;
+  int same = strcmp(rows, expected);
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%li", 256L, "%li", pos, {});
+  t_exp("%i", 0, "%i", same, { printf("%s", output); });
+  free(output);
+  t_ok();
+}
+
+void h_test_view_color(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_color);
+  str args[] = {"test", "on"};
+  aa_t aa = {.argc = 2, .argv = args};
+  str vargs[] = {"test", "100"};
+  aa_t vaa = {.argc = 2, .argv = vargs};
+
+  // 7F 45 4C 46 02 01 01 00: control, printable, then zero cells
+  cstr hex = "0000000000000000|\x1b[35m7F\x1b[0m \x1b[36m45\x1b[0m "
+             "\x1b[36m4C\x1b[0m \x1b[36m46\x1b[0m|\x1b[35m02\x1b[0m "
+             "\x1b[35m01\x1b[0m \x1b[35m01\x1b[0m \x1b[90m00\x1b[0m|";
+  cstr ascii = "\x1b[35m.\x1b[0m\x1b[36mE\x1b[0m\x1b[36mL\x1b[0m";
+  FILE *tmp;
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int color = app.hex->color;
+  int saved = h_util_capture(&tmp);
+  int result = h_view(&app.app, &vaa);
+  str output = h_util_captured(tmp, saved);
+
+  // assert
+  int cells = strstr(output, hex) != NULL;
+  int glyphs = strstr(output, ascii) != NULL;
+  h_util_destroy_app(&app);
+  t_exp("%i", 1, "%i", color, {});
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", 1, "%i", cells, { printf("%s", output); });
+  t_exp("%i", 1, "%i", glyphs, {});
+  free(output);
+  t_ok();
+}
+
+void h_test_color_failed(void) {
+  // arrange
+  hexapp_t app = h_util_create_app(h_color);
+  str args[] = {"test", "blue"};
+  aa_t aa = {.argc = 2, .argv = args};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+
+  // assert
+  int result = app.app.result;
+  int color = app.hex->color;
+  a_deinit(&app.app);
+  t_exp("%i", he_number, "%i", result, {});
+  t_exp("%i", 0, "%i", color, {});
+  t_ok();
+}
+
 void h_test_find(void) {
   // arrange
   hexapp_t app = h_util_create_app_open_file(h_find);
@@ -207,6 +372,973 @@ void h_test_findx(void) {
   t_ok();
 }
 
+void h_test_find_sparse(void) {
+  // arrange
+  FILE *file = fopen("sparse.sample", "w");
+  fseek(file, 1L << 24, SEEK_SET);
+  fwrite("ELF", 1, 3, file);
+  fclose(file);
+
+  hexapp_t app = h_util_create_app(h_find);
+  s_openfile(&app.hex->stream, "sparse.sample", sm_binary_read);
+  app.hex->state = hs_occupied;
+  str args[] = {"test", "ELF", "0"};
+  aa_t aa = {.argc = 3, .argv = args};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+
+  // assert
+  int result = app.app.result;
+  h_util_destroy_app(&app);
+  remove("sparse.sample");
+  t_exp("%i", he_ok, "%i", result, {});
+  t_ok();
+}
+
+void h_test_diff(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_diff);
+  str args[] = {"test", "dump.sample"};
+  aa_t aa = {.argc = 2, .argv = args};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+
+  // assert
+  int result = app.app.result;
+  long pos = ftell(app.hex->stream.handle);
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%li", 0L, "%li", pos, {});
+  t_ok();
+}
+
+void h_test_diff_changed(void) {
+  // arrange
+  uint8_t data[80] = {0};
+  FILE *file = fopen("short.sample", "w");
+  fwrite(data, 1, 64, file);
+  fclose(file);
+  data[5] = 1;
+  data[6] = 2;
+  data[40] = 9;
+  file = fopen("long.sample", "w");
+  fwrite(data, 1, 80, file);
+  fclose(file);
+
+  hexapp_t app = h_util_create_app_open(h_diff, "short.sample");
+  str args[] = {"test", "long.sample"};
+  aa_t aa = {.argc = 2, .argv = args};
+  FILE *tmp;
+
+  // act
+  int saved = h_util_capture(&tmp);
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  str out = h_util_captured(tmp, saved);
+
+  // assert
+  int result = app.app.result;
+  h_util_destroy_app(&app);
+  remove("short.sample");
+  remove("long.sample");
+  cstr expected[] = {
+      "0000000000000000|", "0000000000000020|",
+      "0000000000000005-0000000000000007 2 bytes\n",
+      "0000000000000028-0000000000000029 1 bytes\n",
+      "0000000000000040-0000000000000050 16 bytes\n",
+      "3 changed ranges, 19 bytes differ.\n",
+      "Sizes differ: 64 and 80 bytes.\n",
+  };
+  int found = 0;
+  for (int i = 0; i < 7; i++)
+    found += strstr(out, expected[i]) != NULL;
+  int rows = strstr(out, "0000000000000010|") == NULL;
+  free(out);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", 7, "%i", found, {});
+  t_exp("%i", 1, "%i", rows, {});
+  t_ok();
+}
+
+void h_test_diff_failed(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_diff);
+  str args[] = {"test", "elephant.elf"};
+  aa_t aa = {.argc = 2, .argv = args};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+
+  // assert
+  int result = app.app.result;
+  h_util_destroy_app(&app);
+  t_exp("%i", se_null, "%i", result, {});
+  t_ok();
+}
+
+void h_test_table(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_table);
+  str args[] = {"test", "u16,u16,u32,x64,u64,u64", "4"};
+  aa_t aa = {.argc = 3, .argv = args};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+
+  // assert
+  int result = app.app.result;
+  long pos = ftell(app.hex->stream.handle);
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%li", 128L, "%li", pos, {});
+  t_ok();
+}
+
+void h_test_table_bounded(void) {
+  // arrange
+  FILE *file = fopen("records.sample", "w");
+  fseek(file, (32L << 20) - 1, SEEK_SET);
+  fputc(0, file);
+  fclose(file);
+
+  hexapp_t app = h_util_create_app_open(h_table, "records.sample");
+  str args[] = {"test", "u64", "5000000000"};
+  aa_t aa = {.argc = 3, .argv = args};
+  FILE *tmp;
+
+  // act
+  int saved = h_util_capture(&tmp);
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  s_move(&app.hex->stream, 1L << 26);
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int past = app.app.result;
+  str out = h_util_captured(tmp, saved);
+
+  // assert
+  h_util_destroy_app(&app);
+  remove("records.sample");
+  int limited = strstr(out, "table limited to 2796202 records") != NULL;
+  int none = strstr(out, "only 0 complete records left") != NULL;
+  free(out);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", 1, "%i", limited, {});
+  t_exp("%i", he_size, "%i", past, {});
+  t_exp("%i", 1, "%i", none, {});
+  t_ok();
+}
+
+void h_test_hash(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_hash);
+  str args[] = {"test", "sha256", "16", "64"};
+  str bad[] = {"test", "md5"};
+  aa_t aa = {.argc = 4, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", de_algo, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_entropy(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_entropy);
+  str args[] = {"test", "4096"};
+  str bad[] = {"test", "0"};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  long pos = ftell(app.hex->stream.handle);
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_size, "%i", failed, {});
+  t_exp("%li", 0L, "%li", pos, {});
+  t_ok();
+}
+
+void h_test_chunks(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_chunks);
+  str args[] = {"test", "1024"};
+  str bad[] = {"test", "1000"};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", ce_size, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_dupes(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_dupes);
+  str args[] = {"test", "fixed", "16"};
+  str cdc[] = {"test", "cdc"};
+  str bad[] = {"test", "sliding"};
+  aa_t aa = {.argc = 3, .argv = args};
+  aa_t aacdc = {.argc = 2, .argv = cdc};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aacdc);
+  int resultcdc = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_ok, "%i", resultcdc, {});
+  t_exp("%i", he_argc, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_delta(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_delta);
+  str args[] = {"test", "dump.sample", "256"};
+  str bad[] = {"test", "elephant.elf"};
+  aa_t aa = {.argc = 3, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", se_null, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_fuzzy(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_fuzzy);
+  str args[] = {"test", "96:abcdefg:hij"};
+  str bad[] = {"test", "96:abcdefg:hij", "abcdefg"};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 3, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_number, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_runs(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_runs);
+  str args[] = {"test", "8"};
+  str bad[] = {"test", "1"};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", fe_size, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_ngrams(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_ngrams);
+  str args[] = {"test", "4", "10"};
+  str bad[] = {"test", "9", "10"};
+  aa_t aa = {.argc = 3, .argv = args};
+  aa_t aabad = {.argc = 3, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", qe_size, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_findval(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_findval);
+  str args[] = {"test", "u16", "0x7F45", "2"};
+  str bad[] = {"test", "u24", "1"};
+  aa_t aa = {.argc = 4, .argv = args};
+  aa_t aabad = {.argc = 3, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", fe_type, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_findxor(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_findxor);
+  str args[] = {"test", "7F454C46", "2"};
+  str bad[] = {"test", "7F45", "2"};
+  aa_t aa = {.argc = 3, .argv = args};
+  aa_t aabad = {.argc = 3, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", fe_size, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_findbits(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_findbits);
+  str args[] = {"test", "0111111101000101"};
+  str bad[] = {"test", "01112"};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_number, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_findval_all(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_findval);
+  str args[] = {"test", "u16", "0"};
+  str bytes[] = {"insert", "00"};
+  aa_t aa = {.argc = 3, .argv = args};
+  aa_t aains = {.argc = 2, .argv = bytes};
+  FILE *tmp;
+
+  // act
+  int saved = h_util_capture(&tmp);
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  long found = app.hex->hits.num;
+  long last = found > 0 ? app.hex->hits.offsets[found - 1] : -1;
+  h_insert(&app.app, &aains);
+  long kept = app.hex->hits.num;
+  str out = h_util_captured(tmp, saved);
+
+  // assert
+  h_util_destroy_app(&app);
+  int capped = strstr(out, "display limited to 256 of 13033") != NULL;
+  free(out);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", 1, "%i", capped, {});
+  t_exp("%li", 13033L, "%li", found, {});
+  t_exp("%li", 30990L, "%li", last, {});
+  t_exp("%li", 0L, "%li", kept, {});
+  t_ok();
+}
+
+void h_test_hits(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_findval);
+  str args[] = {"test", "u16", "0"};
+  str max[] = {"hits", "1000"};
+  str bad[] = {"hits", "0"};
+  aa_t aa = {.argc = 3, .argv = args};
+  FILE *tmp;
+
+  // act
+  int saved = h_util_capture(&tmp);
+  int failed = h_hits(&app.app, &(aa_t){.argc = 2, .argv = bad});
+  int result = h_hits(&app.app, &(aa_t){.argc = 2, .argv = max});
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  long kept = app.hex->hits.num;
+  str out = h_util_captured(tmp, saved);
+
+  // assert
+  h_util_destroy_app(&app);
+  int warned = strstr(out, "only the first 1000 offsets") != NULL;
+  int total = strstr(out, "13033 matches.") != NULL;
+  free(out);
+  t_exp("%i", he_size, "%i", failed, {});
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%li", 1000L, "%li", kept, {});
+  t_exp("%i", 1, "%i", warned, {});
+  t_exp("%i", 1, "%i", total, {});
+  t_ok();
+}
+
+void h_test_overwrite(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_overwrite);
+  str args[] = {"test", "DEADBEEF"};
+  str bad[] = {"test", "DEADBEEG"};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  long size = app.hex->stream.size;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+  long original = app.hex->file.size;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_number, "%i", failed, {});
+  t_exp("%li", original + 0L, "%li", size, {});
+  t_ok();
+}
+
+void h_test_insert(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_insert);
+  str args[] = {"test", "DEADBEEF"};
+  str bad[] = {"test", "-1"};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  long size = app.hex->stream.size;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+  long original = app.hex->file.size;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_number, "%i", failed, {});
+  t_exp("%li", original + 4L, "%li", size, {});
+  t_ok();
+}
+
+void h_test_delete(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_delete);
+  str args[] = {"test", "16"};
+  str bad[] = {"test", "-1"};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  long size = app.hex->stream.size;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+  long original = app.hex->file.size;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", ee_range, "%i", failed, {});
+  t_exp("%li", original + -16L, "%li", size, {});
+  t_ok();
+}
+
+void h_test_replace(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_replace);
+  str args[] = {"test", "00", "ABCD", "4096"};
+  str bad[] = {"test", "00", "XY"};
+  aa_t aa = {.argc = 4, .argv = args};
+  aa_t aabad = {.argc = 3, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  long grown = app.hex->stream.size - app.hex->file.size;
+  long edits = app.hex->edit.history.num;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+  h_undo(&app.app, &(aa_t){.argc = 1, .argv = args});
+  long done = app.hex->edit.history.done;
+  long size = app.hex->stream.size - app.hex->file.size;
+
+  // assert: one undo reverts every occurrence
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_number, "%i", failed, {});
+  t_exp("%li", 3349L, "%li", grown, {});
+  t_exp("%i", 1, "%i", (edits * 10 < grown), {});
+  t_exp("%li", 0L, "%li", done, {});
+  t_exp("%li", 0L, "%li", size, {});
+  t_ok();
+}
+
+void h_test_undo(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_undo);
+  str edit[] = {"overwrite", "DEADBEEF"};
+  str args[] = {"test"};
+  aa_t aaedit = {.argc = 2, .argv = edit};
+  aa_t aa = {.argc = 1, .argv = args};
+  h_overwrite(&app.app, &aaedit);
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int failed = app.app.result;
+
+  // assert
+  long done = app.hex->edit.history.done;
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", ee_range, "%i", failed, {});
+  t_exp("%li", 0L, "%li", done, {});
+  t_ok();
+}
+
+void h_test_redo(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_redo);
+  str edit[] = {"overwrite", "DEADBEEF"};
+  str args[] = {"test"};
+  aa_t aaedit = {.argc = 2, .argv = edit};
+  aa_t aa = {.argc = 1, .argv = args};
+  h_overwrite(&app.app, &aaedit);
+  e_undo(&app.hex->edit, &(long){0});
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int failed = app.app.result;
+
+  // assert
+  long done = app.hex->edit.history.done;
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", ee_range, "%i", failed, {});
+  t_exp("%li", 1L, "%li", done, {});
+  t_ok();
+}
+
+void h_test_save(void) {
+  // arrange
+  FILE *file = fopen("save.sample", "w");
+  fputs("0123456789", file);
+  fclose(file);
+
+  hexapp_t app = h_util_create_app_open(h_save, "save.sample");
+  str edit[] = {"overwrite", "4142"};
+  str args[] = {"test"};
+  str bad[] = {"test", "now"};
+  aa_t aaedit = {.argc = 2, .argv = edit};
+  aa_t aa = {.argc = 1, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+  char out[11] = {0};
+
+  // act
+  h_overwrite(&app.app, &aaedit);
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  file = fopen("save.sample", "r");
+  fread(out, 1, 10, file);
+  fclose(file);
+  remove("save.sample");
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_argc, "%i", failed, {});
+  t_sexp("AB23456789", 11L, out, strlen(out) + 1, {});
+  t_ok();
+}
+
+void h_test_patch(void) {
+  // arrange
+  FILE *file = fopen("patch.sample", "w");
+  fputs("0123456789", file);
+  fclose(file);
+
+  hexapp_t app = h_util_create_app_open(h_patch, "patch.sample");
+  str edit[] = {"overwrite", "4142"};
+  str args[] = {"test", "export", "patch.hxp"};
+  str bad[] = {"test", "apply", "patch.hxp"};
+  aa_t aaedit = {.argc = 2, .argv = edit};
+  aa_t aa = {.argc = 3, .argv = args};
+  aa_t aabad = {.argc = 3, .argv = bad};
+
+  // act
+  h_overwrite(&app.app, &aaedit);
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  int exported = access("patch.hxp", F_OK);
+  remove("patch.sample");
+  remove("patch.hxp");
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_state, "%i", failed, {});
+  t_exp("%i", 0, "%i", exported, {});
+  t_ok();
+}
+
+void h_test_extract(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_extract);
+  f_pushoffset(&app.hex->hits, 0);
+  f_pushoffset(&app.hex->hits, 16);
+  str args[] = {"test", "{}", "8", "extract.{}.tmp"};
+  str bad[] = {"test", "{}", "8", "extract.tmp"};
+  aa_t aa = {.argc = 4, .argv = args};
+  aa_t aabad = {.argc = 4, .argv = bad};
+  uint8_t out[9] = {0};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  FILE *file = fopen("extract.0000000000000010.tmp", "r");
+  long read = file != NULL ? (long)fread(out, 1, sizeof(out), file) : 0;
+  if (file != NULL)
+    fclose(file);
+  int first = access("extract.0000000000000000.tmp", F_OK);
+  remove("extract.0000000000000000.tmp");
+  remove("extract.0000000000000010.tmp");
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_argc, "%i", failed, {});
+  t_exp("%i", 0, "%i", first, {});
+  t_exp("%li", 8L, "%li", read, {});
+  t_ok();
+}
+
+void h_test_files(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_files);
+  str args[] = {"test"};
+  str bad[] = {"test", "1"};
+  aa_t aa = {.argc = 1, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", he_argc, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_use(void) {
+  // arrange
+  hexapp_t app = h_util_create_app_open_file(h_use);
+  app.files.budget = H_BUFFER;
+  str open[] = {"open", "dump.sample"};
+  str args[] = {"test", "1"};
+  str bad[] = {"test", "3"};
+  aa_t aaopen = {.argc = 2, .argv = open};
+  aa_t aa = {.argc = 2, .argv = args};
+  aa_t aabad = {.argc = 2, .argv = bad};
+
+  // act
+  h_open(&app.app, &aaopen);
+  hs_t parked = app.files.slots[0]->state;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aa);
+  int result = app.app.result;
+  int current = (app.hex == app.files.slots[0]);
+  hs_t evicted = app.files.slots[1]->state;
+  a_dispatch(&app.app, "test", app.app.cmdbuf, app.app.cmdnum, &aabad);
+  int failed = app.app.result;
+
+  // assert
+  p_deinit(&app.files.slots[1]->path);
+  h_util_destroy_app(&app);
+  t_exp("%i", hs_parked, "%i", parked, {});
+  t_exp("%i", he_ok, "%i", result, {});
+  t_exp("%i", 1, "%i", current, {});
+  t_exp("%i", hs_parked, "%i", evicted, {});
+  t_exp("%i", he_state, "%i", failed, {});
+  t_ok();
+}
+
+void h_test_serve(void) {
+  // arrange
+  hexapp_t app = h_util_create_app(h_open);
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  strcpy(addr.sun_path, "serve.sock");
+  cstr commands = "test dump.sample\nnothing\n";
+  char reply[256] = {0};
+  char unknown[16];
+  snprintf(unknown, sizeof(unknown), "# %i\n", ae_unknown);
+  long size = 0;
+
+  // act
+  fflush(stdout);
+  pid_t server = fork();
+  if (server == 0)
+    _exit(h_serve(&app, "serve.sock"));
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  while (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    usleep(1000);
+
+  write(fd, commands, strlen(commands));
+  shutdown(fd, SHUT_WR);
+  while (size < sizeof(reply) - 1) {
+    ssize_t got = read(fd, reply + size, sizeof(reply) - 1 - size);
+    if (got <= 0)
+      break;
+    size += got;
+  }
+
+  close(fd);
+  kill(server, SIGTERM);
+  waitpid(server, NULL, 0);
+  int ran = strstr(reply, "# 0\n") != NULL;
+  int failed = strstr(reply, unknown) != NULL;
+  int left = access("serve.sock", F_OK);
+
+  // assert
+  h_util_destroy_app(&app);
+  t_exp("%i", 1, "%i", ran, {});
+  t_exp("%i", 1, "%i", failed, {});
+  t_exp("%i", -1, "%i", left, {});
+  t_ok();
+}
+
+void h_test_serve_stalled(void) {
+  // arrange
+  hexapp_t app;
+  h_init(&app);
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  strcpy(addr.sun_path, "stalled.sock");
+  char views[1024] = "open dump.sample\n";
+  for (int i = 0; i < 64; i++)
+    strcat(views, "view 0 4096\n");
+  cstr command = "nothing\n";
+  char reply[64] = {0};
+  char unknown[16];
+  snprintf(unknown, sizeof(unknown), "# %i\n", ae_unknown);
+  long size = 0;
+
+  // act
+  fflush(stdout);
+  pid_t server = fork();
+  if (server == 0)
+    _exit(h_serve(&app, "stalled.sock"));
+
+  // the 1st client reads none of its output, more than its socket holds
+  int fds[2];
+  for (int i = 0; i < 2; i++) {
+    fds[i] = socket(AF_UNIX, SOCK_STREAM, 0);
+    while (connect(fds[i], (struct sockaddr *)&addr, sizeof(addr)) != 0)
+      usleep(1000);
+  }
+  write(fds[0], views, strlen(views));
+  usleep(100000);
+  write(fds[1], command, strlen(command));
+
+  struct pollfd reading = {.fd = fds[1], .events = POLLIN};
+  while (strstr(reply, unknown) == NULL && size < sizeof(reply) - 1 &&
+         poll(&reading, 1, 5000) == 1) {
+    ssize_t got = read(fds[1], reply + size, sizeof(reply) - 1 - size);
+    if (got <= 0)
+      break;
+    size += got;
+  }
+
+  close(fds[0]);
+  close(fds[1]);
+  kill(server, SIGTERM);
+  waitpid(server, NULL, 0);
+  int served = strstr(reply, unknown) != NULL;
+
+  // assert
+  h_deinit(&app);
+  t_exp("%i", 1, "%i", served, {});
+  t_ok();
+}
+
+void h_test_serve_shared(void) {
+  // arrange
+  hexapp_t app;
+  h_init(&app);
+  cstr open = "open dump.sample\n";
+  cstr again = "open ./dump.sample\nfiles\n";
+  cstr files = "files\n";
+  char first[256], reopened[256], held[256], left[256];
+
+  // act
+  fflush(stdout);
+  pid_t server = fork();
+  if (server == 0)
+    _exit(h_serve(&app, "shared.sock"));
+
+  int fd = h_util_connect("shared.sock");
+  write(fd, open, strlen(open));
+  h_util_reply(fd, first, sizeof(first), "# 0\n");
+
+  // the others come and go while the 1st holds the file
+  int other = h_util_connect("shared.sock");
+  write(other, again, strlen(again));
+  shutdown(other, SHUT_WR);
+  h_util_reply(other, reopened, sizeof(reopened), NULL);
+  close(other);
+
+  other = h_util_connect("shared.sock");
+  write(other, files, strlen(files));
+  shutdown(other, SHUT_WR);
+  h_util_reply(other, held, sizeof(held), NULL);
+  close(other);
+
+  shutdown(fd, SHUT_WR);
+  h_util_reply(fd, first, sizeof(first), NULL);
+  close(fd);
+
+  other = h_util_connect("shared.sock");
+  write(other, files, strlen(files));
+  shutdown(other, SHUT_WR);
+  h_util_reply(other, left, sizeof(left), NULL);
+  close(other);
+
+  kill(server, SIGTERM);
+  waitpid(server, NULL, 0);
+  int reused = strstr(reopened, "already open as #1") != NULL;
+  int one = strstr(reopened, "1 files open.") != NULL;
+  int kept = strstr(held, "1 files open.") != NULL;
+  int closed = strstr(left, "0 files open.") != NULL;
+
+  // assert
+  h_deinit(&app);
+  t_exp("%i", 1, "%i", reused, {});
+  t_exp("%i", 1, "%i", one, {});
+  t_exp("%i", 1, "%i", kept, {});
+  t_exp("%i", 1, "%i", closed, {});
+  t_ok();
+}
+
+void h_test_serve_concurrent(void) {
+  // arrange
+  FILE *file = fopen("long.sample", "w");
+  fseek(file, (1L << 28) - 1, SEEK_SET);
+  fputc(0, file);
+  fclose(file);
+
+  hexapp_t app;
+  h_init(&app);
+  cstr open = "open long.sample\n";
+  cstr hash = "hash sha256\n";
+  cstr view = "open dump.sample\nview 0 16\n";
+  char opened[256], viewed[1024], hashed[256];
+
+  // act
+  fflush(stdout);
+  pid_t server = fork();
+  if (server == 0)
+    _exit(h_serve(&app, "concurrent.sock"));
+
+  int slow = h_util_connect("concurrent.sock");
+  write(slow, open, strlen(open));
+  h_util_reply(slow, opened, sizeof(opened), "# 0\n");
+  write(slow, hash, strlen(hash));
+
+  // the other client is served while the hash runs
+  int fast = h_util_connect("concurrent.sock");
+  write(fast, view, strlen(view));
+  shutdown(fast, SHUT_WR);
+  h_util_reply(fast, viewed, sizeof(viewed), NULL);
+  close(fast);
+
+  struct pollfd hashing = {.fd = slow, .events = POLLIN};
+  int waited = poll(&hashing, 1, 0) == 0;
+  shutdown(slow, SHUT_WR);
+  h_util_reply(slow, hashed, sizeof(hashed), NULL);
+  close(slow);
+
+  kill(server, SIGTERM);
+  waitpid(server, NULL, 0);
+  remove("long.sample");
+  int shown = strstr(viewed, "7F 45 4C 46") != NULL;
+  int done = strstr(hashed, "sha256 ") != NULL;
+
+  // assert
+  h_deinit(&app);
+  t_exp("%i", 1, "%i", shown, {});
+  t_exp("%i", 1, "%i", waited, {});
+  t_exp("%i", 1, "%i", done, {});
+  t_ok();
+}
+
 int main() {
   h_test_open();
   h_test_open_failed();
@@ -215,7 +1347,44 @@ int main() {
   h_test_move_somehow_works();
   h_test_view();
   h_test_view_failed();
+  h_test_view_folded();
+  h_test_view_color();
+  h_test_color_failed();
   h_test_find();
   h_test_findx();
+  h_test_find_sparse();
+  h_test_diff();
+  h_test_diff_changed();
+  h_test_diff_failed();
+  h_test_table();
+  h_test_table_bounded();
+  h_test_hash();
+  h_test_entropy();
+  h_test_chunks();
+  h_test_dupes();
+  h_test_delta();
+  h_test_fuzzy();
+  h_test_runs();
+  h_test_ngrams();
+  h_test_findval();
+  h_test_findxor();
+  h_test_findbits();
+  h_test_findval_all();
+  h_test_hits();
+  h_test_overwrite();
+  h_test_insert();
+  h_test_delete();
+  h_test_replace();
+  h_test_undo();
+  h_test_redo();
+  h_test_save();
+  h_test_patch();
+  h_test_extract();
+  h_test_files();
+  h_test_use();
+  h_test_serve();
+  h_test_serve_stalled();
+  h_test_serve_shared();
+  h_test_serve_concurrent();
   return 0;
 }
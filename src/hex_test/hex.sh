@@ -2,10 +2,12 @@
 # Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
 #
 
-files=("hex.c" "../hex.c" "../stream.c" "../app.c" "../path.c")
+files=("hex.c" "../hex.c" "../stream.c" "../app.c" "../path.c"
+       "../record.c" "../digest.c" "../freq.c" "../chunk.c"
+       "../find.c" "../edit.c")
 output="hex.elf"
 
-gcc ${files[@]} -o $output -ggdb
+gcc ${files[@]} -o $output -ggdb -pthread -lm
 if [ $? -eq 0 ]; then
   chmod +x $output
 
@@ -1,22 +1,77 @@
 #include "hex.h"
 
+static int usage(cstr name) {
+  fprintf(stderr, "Usage: %s [-c \"command; ...\" | -f script | -s socket]\n",
+          name);
+  return he_argc;
+}
+
 int main(int argc, char **argv) {
   hexapp_t app;
-  aa_t aa;
-  int err;
+  FILE *input = NULL;
+  str commands = NULL;
+  cstr server = NULL;
+  int opt, err;
+
+  while ((opt = getopt(argc, argv, "c:f:s:")) != -1) {
+    if (input != NULL || server != NULL ||
+        (opt != 'c' && opt != 'f' && opt != 's'))
+      return usage(argv[0]);
+
+    if (opt == 's') {
+      server = optarg;
+      continue;
+    }
+
+    // commands of -c are separated by ';', those of a script by lines
+    if (opt == 'c') {
+      commands = strdup(optarg);
+      assert(commands != NULL);
+      for (str c = commands; *c != '\0'; c++)
+        *c = *c == ';' ? '\n' : *c;
+      input = fmemopen(commands, strlen(commands), "r");
+    } else {
+      input = fopen(optarg, "r");
+    }
+
+    if (input == NULL) {
+      fprintf(stderr, "Failed to read '%s'.\n", optarg);
+      free(commands);
+      return he_read;
+    }
+  }
+
+  if (optind < argc) {
+    if (input != NULL)
+      fclose(input);
+    free(commands);
+    return usage(argv[0]);
+  }
 
   err = h_init(&app);
   if (err)
     return err;
 
-  while (a_closed(&app.app) != ae_closed) {
-    err = a_prompt(&app.app, &aa);
-    if (err)
-      return err;
+  // the files stay open while a client holds them
+  if (server != NULL) {
+    err = h_serve(&app, server);
+    h_deinit(&app);
+    return err;
+  }
 
-    a_dispatch(&app.app, aa.argv[0], app.app.cmdbuf, app.app.cmdnum, &aa);
+  // no prompt and full buffering: output goes to a pipe or a file
+  if (input != NULL) {
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+    app.app.istream = input;
+    app.app.batch = 1;
   }
 
+  a_run(&app.app);
+  int result = app.app.batch ? app.app.result : 0;
   h_deinit(&app);
-  return 0;
+
+  if (input != NULL)
+    fclose(input);
+  free(commands);
+  return result;
 }
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "record.h"
+
+#define check_re(re, clean)                                                    \
+  if (re != re_ok) {                                                           \
+    clean;                                                                     \
+    return re;                                                                 \
+  }
+
+/*******************************************************************************
+ *                       Internal utility functions
+ *******************************************************************************/
+
+static re_t r_field(rf_t *out, cstr token, long length) {
+  static const char kinds[] = "uifx";
+  char spec[16] = {0};
+  char *end;
+
+  if (length <= 1 || length >= (long)sizeof(spec))
+    return re_layout;
+
+  memcpy(spec, token, length);
+  char *kind = strchr(kinds, spec[0]);
+  if (kind == NULL)
+    return re_type;
+
+  long bits = strtol(spec + 1, &end, 10);
+  int bigendian = strcmp(end, "be") == 0;
+  int littleendian = strcmp(end, "le") == 0 || *end == '\0';
+  if (!bigendian && !littleendian)
+    return re_layout;
+
+  int pow2 = bits == 8 || bits == 16 || bits == 32 || bits == 64;
+  int fsize = bits == 32 || bits == 64;
+  if (!pow2 || (*kind == 'f' && !fsize))
+    return re_width;
+
+  out->kind = kind - kinds;
+  out->width = bits / 8;
+  out->bigendian = bigendian;
+  memcpy(out->name, spec, sizeof(out->name));
+  return re_ok;
+}
+
+static uint64_t r_load(int8_t *p, long width, int bigendian) {
+  // hosts are little endian (x86-64, aarch64)
+  uint64_t value = 0;
+  memcpy(&value, p, width);
+  if (bigendian)
+    value = __builtin_bswap64(value) >> (64 - 8 * width);
+  return value;
+}
+
+static int r_cmp(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void r_minmax_u(rv_t *col, long n, rv_t *min, rv_t *max) {
+  v4u_t lo = (v4u_t){0} + col[0].u;
+  v4u_t hi = lo;
+  long i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    v4u_t x;
+    memcpy(&x, col + i, sizeof(x));
+    v4u_t lt = (v4u_t)(x < lo);
+    v4u_t gt = (v4u_t)(x > hi);
+    lo = (x & lt) | (lo & ~lt);
+    hi = (x & gt) | (hi & ~gt);
+  }
+
+  min->u = lo[0];
+  max->u = hi[0];
+  for (int l = 1; l < 4; l++) {
+    min->u = lo[l] < min->u ? lo[l] : min->u;
+    max->u = hi[l] > max->u ? hi[l] : max->u;
+  }
+
+  for (; i < n; i++) {
+    min->u = col[i].u < min->u ? col[i].u : min->u;
+    max->u = col[i].u > max->u ? col[i].u : max->u;
+  }
+}
+
+static void r_minmax_i(rv_t *col, long n, rv_t *min, rv_t *max) {
+  v4i_t lo = (v4i_t){0} + col[0].i;
+  v4i_t hi = lo;
+  long i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    v4i_t x;
+    memcpy(&x, col + i, sizeof(x));
+    v4i_t lt = x < lo;
+    v4i_t gt = x > hi;
+    lo = (x & lt) | (lo & ~lt);
+    hi = (x & gt) | (hi & ~gt);
+  }
+
+  min->i = lo[0];
+  max->i = hi[0];
+  for (int l = 1; l < 4; l++) {
+    min->i = lo[l] < min->i ? lo[l] : min->i;
+    max->i = hi[l] > max->i ? hi[l] : max->i;
+  }
+
+  for (; i < n; i++) {
+    min->i = col[i].i < min->i ? col[i].i : min->i;
+    max->i = col[i].i > max->i ? col[i].i : max->i;
+  }
+}
+
+static void r_minmax_f(rv_t *col, long n, rv_t *min, rv_t *max) {
+  v4d_t lo = (v4d_t){0} + col[0].f;
+  v4d_t hi = lo;
+  long i = 0;
+
+  // lanes are selected through their bits, NaN never replaces a lane
+  for (; i + 4 <= n; i += 4) {
+    v4d_t x;
+    memcpy(&x, col + i, sizeof(x));
+    v4i_t lt = x < lo;
+    v4i_t gt = x > hi;
+    lo = (v4d_t)(((v4i_t)x & lt) | ((v4i_t)lo & ~lt));
+    hi = (v4d_t)(((v4i_t)x & gt) | ((v4i_t)hi & ~gt));
+  }
+
+  min->f = lo[0];
+  max->f = hi[0];
+  for (int l = 1; l < 4; l++) {
+    min->f = lo[l] < min->f ? lo[l] : min->f;
+    max->f = hi[l] > max->f ? hi[l] : max->f;
+  }
+
+  for (; i < n; i++) {
+    min->f = col[i].f < min->f ? col[i].f : min->f;
+    max->f = col[i].f > max->f ? col[i].f : max->f;
+  }
+}
+
+/*******************************************************************************
+ *                            Record functions
+ *******************************************************************************/
+
+re_t r_parse(rl_t *out, cstr layout) {
+  assert(out != NULL);
+  assert(layout != NULL);
+  memset(out, 0, sizeof(*out));
+
+  cstr token = layout;
+  while (*token != '\0') {
+    if (out->num == sizeof(out->fields) / sizeof(out->fields[0]))
+      return re_fields;
+
+    long length = strcspn(token, ",");
+    rf_t *field = &out->fields[out->num];
+    re_t err = r_field(field, token, length);
+    check_re(err, {});
+
+    field->offset = out->size;
+    out->size += field->width;
+    out->num++;
+    token += length + (token[length] == ',');
+  }
+
+  return out->num > 0 ? re_ok : re_layout;
+}
+
+re_t r_decode(rl_t *layout, int8_t *data, long count, rv_t **columns) {
+  assert(layout != NULL);
+  assert(data != NULL);
+  assert(columns != NULL);
+
+  // one pass per field, so every column is written sequentially
+  for (long f = 0; f < layout->num; f++) {
+    rf_t *field = &layout->fields[f];
+    rv_t *col = columns[f];
+    int8_t *p = data + field->offset;
+    long shift = 64 - 8 * field->width;
+
+    for (long r = 0; r < count; r++) {
+      col[r].u = r_load(p + r * layout->size, field->width, field->bigendian);
+    }
+
+    if (field->kind == rk_signed) {
+      for (long r = 0; r < count; r++)
+        col[r].i = (int64_t)(col[r].u << shift) >> shift;
+    }
+
+    else if (field->kind == rk_float && field->width == 4) {
+      for (long r = 0; r < count; r++) {
+        uint32_t bits = col[r].u;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        col[r].f = value;
+      }
+    }
+  }
+
+  return re_ok;
+}
+
+re_t r_stats(rf_t *field, rv_t *column, long count, rs_t *out) {
+  assert(field != NULL);
+  assert(column != NULL);
+  assert(out != NULL);
+  memset(out, 0, sizeof(*out));
+
+  if (count <= 0)
+    return re_ok;
+
+  if (field->kind == rk_signed)
+    r_minmax_i(column, count, &out->min, &out->max);
+  else if (field->kind == rk_float)
+    r_minmax_f(column, count, &out->min, &out->max);
+  else
+    r_minmax_u(column, count, &out->min, &out->max);
+
+  // distinct values are counted on the bit patterns
+  uint64_t *sorted = malloc(sizeof(uint64_t) * count);
+  assert(sorted != NULL);
+  memcpy(sorted, column, sizeof(uint64_t) * count);
+  qsort(sorted, count, sizeof(uint64_t), r_cmp);
+
+  out->distinct = 1;
+  for (long i = 1; i < count; i++) {
+    out->distinct += sorted[i] != sorted[i - 1];
+  }
+
+  free(sorted);
+  return re_ok;
+}
+
+int r_format(rf_t *field, rv_t value, str out, long size) {
+  assert(field != NULL);
+  assert(out != NULL);
+
+  switch (field->kind) {
+  case rk_signed:
+    return snprintf(out, size, "%li", value.i);
+  case rk_float:
+    return snprintf(out, size, "%g", value.f);
+  case rk_hex:
+    return snprintf(out, size, "0x%0*lx", (int)field->width * 2, value.u);
+  default:
+    return snprintf(out, size, "%lu", value.u);
+  }
+}
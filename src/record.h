@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "typedef.h"
+#include "vector.h"
+
+/*******************************************************************************
+ *                          Record object definitions
+ *******************************************************************************/
+
+/*
+ * Record error codes
+ */
+typedef enum { re_ok, re_layout, re_type, re_width, re_fields } re_t;
+
+/*
+ * Record field kind
+ */
+typedef enum { rk_unsigned, rk_signed, rk_float, rk_hex } rk_t;
+
+/*
+ * Record field
+ */
+typedef struct {
+  rk_t kind;
+  long width;
+  long offset;
+  int bigendian;
+  char name[16];
+} rf_t;
+
+/*
+ * Record layout
+ */
+typedef struct {
+  rf_t fields[32];
+  long num;
+  long size;
+} rl_t;
+
+/*
+ * Record column value
+ */
+typedef union {
+  uint64_t u;
+  int64_t i;
+  double f;
+} rv_t;
+
+/*
+ * Record column statistics
+ */
+typedef struct {
+  rv_t min;
+  rv_t max;
+  long distinct;
+} rs_t;
+
+/*******************************************************************************
+ *                            Record functions
+ *******************************************************************************/
+
+/*
+ * Parse a layout such as `u32,i16be,f64le,x8`
+ */
+re_t r_parse(rl_t *out, cstr layout);
+
+/*
+ * Decode `count` records of `data` into one column per field
+ */
+re_t r_decode(rl_t *layout, int8_t *data, long count, rv_t **columns);
+
+/*
+ * Minimum, maximum and distinct count of a column
+ */
+re_t r_stats(rf_t *field, rv_t *column, long count, rs_t *out);
+
+/*
+ * Format one value of a column
+ */
+int r_format(rf_t *field, rv_t value, str out, long size);
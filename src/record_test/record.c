@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#include "../record.h"
+#include "../test.h"
+
+/*******************************************************************************
+ *                            Test data
+ *******************************************************************************/
+
+// 3 records of {u16 le, i32 be, f32 le}
+int8_t r_data[] = {
+    0x01, 0x00, 0xFF, 0xFF, 0xFF, 0xFE, 0x00, 0x00, 0x80, 0x3F,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x40,
+    0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x80, 0xBF,
+};
+
+/*******************************************************************************
+ *                       Test utility functions
+ *******************************************************************************/
+
+void r_util_decode(rl_t *layout, rv_t **columns) {
+  r_parse(layout, "u16,i32be,f32le");
+  for (long f = 0; f < layout->num; f++) {
+    columns[f] = malloc(sizeof(rv_t) * 3);
+  }
+  r_decode(layout, r_data, 3, columns);
+}
+
+void r_util_free(rl_t *layout, rv_t **columns) {
+  for (long f = 0; f < layout->num; f++) {
+    free(columns[f]);
+  }
+}
+
+/*******************************************************************************
+ *                           Test cases
+ *******************************************************************************/
+
+void r_test_parse(void) {
+  // arrange
+  rl_t layout;
+
+  // act
+  re_t error = r_parse(&layout, "u16,i32be,f64,x8");
+
+  // assert
+  t_exp("%i", re_ok, "%i", error, {});
+  t_exp("%li", 4L, "%li", layout.num, {});
+  t_exp("%li", 15L, "%li", layout.size, {});
+  t_exp("%li", 2L, "%li", layout.fields[1].offset, {});
+  t_exp("%i", 1, "%i", layout.fields[1].bigendian, {});
+  t_exp("%i", rk_float, "%i", layout.fields[2].kind, {});
+  t_ok();
+}
+
+void r_test_parse_failed(void) {
+  // arrange
+  rl_t layout;
+
+  // act
+  re_t type = r_parse(&layout, "u16,q32");
+  re_t width = r_parse(&layout, "f16");
+  re_t endian = r_parse(&layout, "i32xe");
+
+  // assert
+  t_exp("%i", re_type, "%i", type, {});
+  t_exp("%i", re_width, "%i", width, {});
+  t_exp("%i", re_layout, "%i", endian, {});
+  t_ok();
+}
+
+void r_test_decode(void) {
+  // arrange
+  rl_t layout;
+  rv_t *columns[3];
+
+  // act
+  r_util_decode(&layout, columns);
+
+  // assert
+  uint64_t u = columns[0][1].u;
+  int64_t i = columns[1][0].i;
+  double f = columns[2][2].f;
+  r_util_free(&layout, columns);
+  t_exp("%lu", 2UL, "%lu", u, {});
+  t_exp("%li", -2L, "%li", i, {});
+  t_exp("%f", -1.0, "%f", f, {});
+  t_ok();
+}
+
+void r_test_stats(void) {
+  // arrange
+  rl_t layout;
+  rv_t *columns[3];
+  rs_t unsig, sig, flt;
+  r_util_decode(&layout, columns);
+
+  // act
+  r_stats(&layout.fields[0], columns[0], 3, &unsig);
+  r_stats(&layout.fields[1], columns[1], 3, &sig);
+  r_stats(&layout.fields[2], columns[2], 3, &flt);
+
+  // assert
+  r_util_free(&layout, columns);
+  t_exp("%lu", 2UL, "%lu", unsig.max.u, {});
+  t_exp("%li", 2L, "%li", unsig.distinct, {});
+  t_exp("%li", -2L, "%li", sig.min.i, {});
+  t_exp("%li", 256L, "%li", sig.max.i, {});
+  t_exp("%f", -1.0, "%f", flt.min.f, {});
+  t_exp("%f", 2.0, "%f", flt.max.f, {});
+  t_ok();
+}
+
+void r_test_stats_vector(void) {
+  // arrange
+  rf_t field = {.kind = rk_signed, .width = 8};
+  rv_t column[11];
+  rs_t stats;
+  for (long i = 0; i < 11; i++) {
+    column[i].i = (i * 7) % 11 - 5;
+  }
+
+  // act
+  r_stats(&field, column, 11, &stats);
+
+  // assert
+  t_exp("%li", -5L, "%li", stats.min.i, {});
+  t_exp("%li", 5L, "%li", stats.max.i, {});
+  t_exp("%li", 11L, "%li", stats.distinct, {});
+  t_ok();
+}
+
+int main(int argc, char **argv) {
+  r_test_parse();
+  r_test_parse_failed();
+  r_test_decode();
+  r_test_stats();
+  r_test_stats_vector();
+  return 0;
+}
@@ -2,6 +2,7 @@
  * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
  */
 
+#define _GNU_SOURCE
 #include "stream.h"
 
 #define check_errno(error, clean)                                              \
@@ -59,6 +60,34 @@ static long s_match(char s_byte, char m_byte, long matching, long size) {
   return bytes_match && size_match;
 }
 
+static int s_fd(stream_t *s) {
+  return s->type == st_file ? fileno(s->handle) : -1;
+}
+
+static long s_sparse(stream_t *s, stream_t *list, size_t num) {
+  if (s_fd(s) < 0)
+    return 0;
+
+  // a needle made of zeros only could match inside a hole
+  long longest = 0;
+  for (stream_t *needle = list; needle != list + num; needle++) {
+    int8_t byte = 0;
+    long read = 1;
+    long nonzero = 0;
+    s_start(needle);
+    while (s_readbyte(needle, &byte, &read) == se_ok && read == 1)
+      nonzero |= byte;
+
+    s_start(needle);
+    if (nonzero == 0)
+      return 0;
+
+    longest = needle->size > longest ? needle->size : longest;
+  }
+
+  return longest;
+}
+
 static long s_canread(sm_t mode) {
   long readmode = (mode & 0x000000FF) == sm_read;
   long plusmode = (mode & 0x0000FF00) == sm_plus;
@@ -148,6 +177,14 @@ se_t s_openmem(stream_t *out, sb_t *mem, sm_t mode) {
   return s_stream(out, handle, type, mode);
 }
 
+se_t s_openhandle(stream_t *out, FILE *handle, sm_t mode) {
+  assert(out != NULL);
+
+  st_t type = st_handle;
+  check_null(handle, { memset(out, 0, sizeof(*out)); });
+  return s_stream(out, handle, type, mode);
+}
+
 se_t s_close(stream_t *s) {
   assert(s != NULL);
   check_handle(s, {});
@@ -343,7 +380,7 @@ se_t s_seek(stream_t *s, stream_t *list, size_t num, long *ndx, long limit) {
   assert(ndx != NULL);
   check_canread(s->mode, {});
 
-  se_t err;
+  se_t err = se_ok;
   long hint = 0;
   long read;
   long step = 1;
@@ -353,7 +390,32 @@ se_t s_seek(stream_t *s, stream_t *list, size_t num, long *ndx, long limit) {
   int8_t m_byte;
   long c = 0;
 
-  while (s_consumable(s, &step, &err) && c < limit) {
+  // holes are skipped between the last bytes a needle could straddle: its
+  // first bytes, ending a match begun in data, and its last ones, before data
+  long longest = s_sparse(s, list, num);
+  long start = ftell(s->handle);
+  long data = start, hole = start, zeros = start;
+
+  while (c < limit && s_consumable(s, &step, &err)) {
+    if (longest > 0 && start + c >= hole) {
+      zeros = start + c;
+      s_extent(s, zeros, &data, &hole);
+    }
+
+    if (longest > 0 && start + c >= zeros + longest - 1) {
+      long skip = data - longest - (start + c);
+      skip = skip < limit - c ? skip : limit - c;
+
+      if (skip > 0) {
+        c += skip;
+        fseek(s->handle, start + c, SEEK_SET);
+        memset(matching, 0, sizeof(long) * num);
+        for (stream_t *needle = list; needle != list + num; needle++)
+          s_start(needle);
+        continue;
+      }
+    }
+
     err = s_readbyte(s, &s_byte, &read);
     if (err)
       break;
@@ -399,3 +461,89 @@ se_t s_consumed(stream_t *s) {
 
   return status == 0 ? se_ok : se_consumed;
 }
+
+se_t s_extent(stream_t *s, long where, long *data, long *hole) {
+  assert(s != NULL);
+  assert(data != NULL);
+  assert(hole != NULL);
+  check_handle(s, {});
+
+  int fd = s_fd(s);
+  *data = where;
+  *hole = s->size;
+  if (fd < 0 || where >= s->size)
+    return se_ok;
+
+  // stdio keeps its own position, the descriptor's offset is restored. The
+  // offset is shared by the threads reading with s_readat: one probe at once.
+  static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+  pthread_mutex_lock(&lock);
+  off_t current = lseek(fd, 0, SEEK_CUR);
+  off_t next = lseek(fd, where, SEEK_DATA);
+  if (next >= 0) {
+    *data = next;
+    next = lseek(fd, next, SEEK_HOLE);
+    *hole = next >= 0 ? next : s->size;
+  }
+
+  // ENXIO: nothing but a hole up to the end
+  else if (errno == ENXIO) {
+    *data = s->size;
+  }
+
+  // EINVAL: no support for holes, keep one extent
+  lseek(fd, current, SEEK_SET);
+  pthread_mutex_unlock(&lock);
+  errno = 0;
+  return se_ok;
+}
+
+se_t s_readat(stream_t *s, sb_t *out, long where, long *read) {
+  assert(s != NULL);
+  assert(out != NULL);
+  assert(out->data != NULL);
+  assert(read != NULL);
+  check_handle(s, {});
+  check_canread(s->mode, {});
+
+  int fd = s_fd(s);
+  long size = out->size;
+  if (where + size > s->size)
+    size = s->size > where ? s->size - where : 0;
+
+  // streams without descriptor are read through stdio
+  if (fd < 0) {
+    long pos = ftell(s->handle);
+    fseek(s->handle, where, SEEK_SET);
+    *read = fread(out->data, 1, size, s->handle);
+    fseek(s->handle, pos, SEEK_SET);
+    check_errno(se_stdio, {});
+    return se_ok;
+  }
+
+  long done = 0;
+  while (done < size) {
+    long data, hole;
+    s_extent(s, where + done, &data, &hole);
+
+    long zeros = data - (where + done);
+    zeros = zeros < size - done ? zeros : size - done;
+    memset((int8_t *)out->data + done, 0, zeros);
+    done += zeros;
+
+    long chunk = hole - (where + done);
+    chunk = chunk < size - done ? chunk : size - done;
+    if (chunk <= 0)
+      continue;
+
+    ssize_t got = pread(fd, (int8_t *)out->data + done, chunk, where + done);
+    if (got <= 0)
+      break;
+
+    done += got;
+  }
+
+  *read = done;
+  check_errno(se_stdio, {});
+  return se_ok;
+}
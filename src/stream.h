@@ -7,10 +7,12 @@
 #include <assert.h>
 #include <errno.h>
 #include <linux/limits.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "typedef.h"
 
@@ -65,6 +67,7 @@ typedef enum : uint64_t {
 typedef enum : uint64_t {
   st_file,
   st_memory,
+  st_handle,
 } st_t;
 
 /*
@@ -104,6 +107,12 @@ se_t s_openfile(stream_t *out, cstr path, sm_t mode);
  */
 se_t s_openmem(stream_t *out, sb_t *mem, sm_t mode);
 
+/*
+ * Open a stream over a handle opened elsewhere, e.g. with fopencookie. The
+ * stream owns the handle.
+ */
+se_t s_openhandle(stream_t *out, FILE *handle, sm_t mode);
+
 /*
  * Close stream
  */
@@ -193,3 +202,15 @@ se_t s_seek(stream_t *s, stream_t *mem, size_t num, long *ndx, long limit);
  * Check if stream reached end-of-file
  */
 se_t s_consumed(stream_t *st);
+
+/*
+ * Get the data extent at or after `where`: [data, hole). Streams without
+ * holes have one extent ending at their size.
+ */
+se_t s_extent(stream_t *s, long where, long *data, long *hole);
+
+/*
+ * Read data at `where` without moving the stream. Holes are zero-filled
+ * without being read.
+ */
+se_t s_readat(stream_t *s, sb_t *out, long where, long *read);
@@ -16,6 +16,8 @@ sb_t s_databuf = s_array(s_data);
 sb_t s_area10buf = s_array(s_area10);
 sb_t s_area20buf = s_array(s_area20);
 const char s_path[] = "dummy.txt";
+const char s_sparsepath[] = "sparse.bin";
+const long s_sparsedata = 1L << 20;
 
 /*******************************************************************************
  *                       Test utility functions
@@ -41,6 +43,14 @@ void s_util_create_file() {
   fclose(file);
 }
 
+void s_util_create_sparse_file() {
+  FILE *file = fopen(s_sparsepath, "w");
+  assert(file != NULL);
+  fseek(file, s_sparsedata, SEEK_SET);
+  fwrite(s_data, 1, sizeof(s_data), file);
+  fclose(file);
+}
+
 stream_t s_util_open_RF(void) {
   FILE *file = fopen(s_path, "r");
   assert(file != NULL);
@@ -83,6 +93,14 @@ stream_t s_util_open_WpM(void) {
   return s_util_init_stream(memory, 0L, sm_writeplus, st_file);
 }
 
+void *s_util_probe(void *arg) {
+  stream_t *stream = arg;
+  long data, hole;
+  for (long i = 0; i < 20000; i++)
+    s_extent(stream, i & 1 ? 0 : s_sparsedata, &data, &hole);
+  return NULL;
+}
+
 /*******************************************************************************
  *                           Test cases
  *******************************************************************************/
@@ -493,6 +511,129 @@ void s_test_seek(void) {
   t_ok();
 }
 
+void s_test_extent(void) {
+  // arrange
+  s_util_create_sparse_file();
+  stream_t stream;
+  s_openfile(&stream, s_sparsepath, sm_binary_read);
+  long data, hole;
+
+  // act
+  se_t error = s_extent(&stream, 0, &data, &hole);
+
+  // assert
+  fclose(stream.handle);
+  remove(s_sparsepath);
+  t_exp("%i", se_ok, "%i", error, {});
+  t_exp("%li", s_sparsedata, "%li", data, {});
+  t_exp("%li", s_sparsedata + (long)sizeof(s_data), "%li", hole, {});
+  t_ok();
+}
+
+void s_test_extent_threads(void) {
+  // arrange
+  s_util_create_sparse_file();
+  stream_t stream;
+  s_openfile(&stream, s_sparsepath, sm_binary_read);
+  int fd = fileno(stream.handle);
+  lseek(fd, 7, SEEK_SET);
+  pthread_t ids[4];
+
+  // act
+  for (long t = 0; t < 4; t++)
+    pthread_create(&ids[t], NULL, s_util_probe, &stream);
+  for (long t = 0; t < 4; t++)
+    pthread_join(ids[t], NULL);
+
+  // assert
+  long offset = lseek(fd, 0, SEEK_CUR);
+  fclose(stream.handle);
+  remove(s_sparsepath);
+  t_exp("%li", 7L, "%li", offset, {});
+  t_ok();
+}
+
+void s_test_readat(void) {
+  // arrange
+  strcpy(s_data, "hello world");
+  s_util_create_sparse_file();
+  stream_t stream;
+  s_openfile(&stream, s_sparsepath, sm_binary_read);
+  char buf[16];
+  sb_t mem = s_array(buf);
+  long read;
+
+  // act
+  se_t error = s_readat(&stream, &mem, s_sparsedata - 4, &read);
+
+  // assert
+  long pos = ftell(stream.handle);
+  fclose(stream.handle);
+  remove(s_sparsepath);
+  t_exp("%i", se_ok, "%i", error, {});
+  t_exp("%li", 16L, "%li", read, {});
+  t_exp("%li", 0L, "%li", pos, {});
+  t_exp("%hhi", 0, "%hhi", buf[0], {});
+  t_exp("%hhi", 'h', "%hhi", buf[4], {});
+  t_exp("%hhi", 'w', "%hhi", buf[10], {});
+  t_ok();
+}
+
+void s_test_seek_sparse(void) {
+  // arrange
+  strcpy(s_data, "hello world");
+  s_util_create_sparse_file();
+  stream_t stream;
+  s_openfile(&stream, s_sparsepath, sm_binary_read);
+  long which;
+  sb_t needle = {.data = "world", .size = 5};
+  stream_t list[1];
+  s_openmem(&list[0], &needle, sm_read);
+
+  // act
+  se_t error = s_seek(&stream, list, 1, &which, stream.size);
+
+  // assert
+  long pos = ftell(stream.handle);
+  fclose(stream.handle);
+  fclose(list[0].handle);
+  remove(s_sparsepath);
+  t_exp("%i", se_ok, "%i", error, {});
+  t_exp("%li", s_sparsedata + 11, "%li", pos, {});
+  t_ok();
+}
+
+void s_test_seek_sparse_edge(void) {
+  // arrange: a block of data ending in 'Z', then a hole
+  FILE *file = fopen(s_sparsepath, "w");
+  assert(file != NULL);
+  char block[4096] = {0};
+  block[sizeof(block) - 1] = 'Z';
+  fwrite(block, 1, sizeof(block), file);
+  fseek(file, s_sparsedata, SEEK_SET);
+  fwrite("tail", 1, 4, file);
+  fclose(file);
+
+  stream_t stream;
+  s_openfile(&stream, s_sparsepath, sm_binary_read);
+  long which;
+  sb_t needle = {.data = "Z\0\0\0\0", .size = 5};
+  stream_t list[1];
+  s_openmem(&list[0], &needle, sm_read);
+
+  // act
+  se_t error = s_seek(&stream, list, 1, &which, stream.size);
+
+  // assert
+  long pos = ftell(stream.handle);
+  fclose(stream.handle);
+  fclose(list[0].handle);
+  remove(s_sparsepath);
+  t_exp("%i", se_ok, "%i", error, {});
+  t_exp("%li", 4100L, "%li", pos, {});
+  t_ok();
+}
+
 int main(int argc, char **argv) {
   s_test_openfile_write();
   s_test_openfile_read();
@@ -515,5 +656,10 @@ int main(int argc, char **argv) {
   s_test_push();
   s_test_pop();
   s_test_seek();
+  s_test_extent();
+  s_test_extent_threads();
+  s_test_readat();
+  s_test_seek_sparse();
+  s_test_seek_sparse_edge();
   return 0;
 }
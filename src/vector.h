@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Gaël Fortier <gael.fortier.1@ens.etsmtl.ca>
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*******************************************************************************
+ *                          Vector object definitions
+ *******************************************************************************/
+
+/*
+ * 16 lanes of 1 byte, lowered to SSE2 on x86-64 and NEON on aarch64
+ */
+typedef uint8_t v16_t __attribute__((vector_size(16)));
+
+/*
+ * Lane-wise comparison result of two v16_t (0 or -1 per lane)
+ */
+typedef int8_t v16m_t __attribute__((vector_size(16)));
+
+/*
+ * 2 lanes of 8 bytes, used to reduce a v16_t
+ */
+typedef uint64_t v2q_t __attribute__((vector_size(16)));
+
+/*
+ * 4 lanes of 8 bytes: signed, unsigned and floating point
+ */
+typedef int64_t v4i_t __attribute__((vector_size(32)));
+typedef uint64_t v4u_t __attribute__((vector_size(32)));
+typedef double v4d_t __attribute__((vector_size(32)));
+
+/*******************************************************************************
+ *                            Vector functions
+ *******************************************************************************/
+
+/*
+ * Load 16 bytes from unaligned memory
+ */
+static inline v16_t v_load(const void *p) {
+  v16_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/*
+ * 16 lanes holding the same byte
+ */
+static inline v16_t v_splat(uint8_t byte) {
+  v16_t v = {0};
+  return v + byte;
+}
+
+/*
+ * Tell if every lane is zero
+ */
+static inline int v_none(v16_t v) {
+  v2q_t q = (v2q_t)v;
+  return (q[0] | q[1]) == 0;
+}
+
+/*
+ * One bit per lane, set when the lane is not zero
+ */
+static inline uint32_t v_mask(v16_t v) {
+#ifdef __SSE2__
+  __m128i m = _mm_cmpeq_epi8((__m128i)v, _mm_setzero_si128());
+  return ~_mm_movemask_epi8(m) & 0xFFFF;
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < 16; i++)
+    mask |= (uint32_t)(v[i] != 0) << i;
+  return mask;
+#endif
+}
+
+/*
+ * One bit per lane, set when lanes of `a` and `b` differ
+ */
+static inline uint32_t v_diffmask(const void *a, const void *b) {
+  return v_mask(v_load(a) ^ v_load(b));
+}
+
+/*
+ * Length of the identical prefix of `a` and `b`, rounded down to 16 bytes
+ */
+static inline long v_same(const void *a, const void *b, long size) {
+  const uint8_t *pa = a;
+  const uint8_t *pb = b;
+  long i = 0;
+
+  // 64 bytes per step, one reduction for four lanes of 16
+  for (; i + 64 <= size; i += 64) {
+    v16_t x = v_load(pa + i) ^ v_load(pb + i);
+    x |= v_load(pa + i + 16) ^ v_load(pb + i + 16);
+    x |= v_load(pa + i + 32) ^ v_load(pb + i + 32);
+    x |= v_load(pa + i + 48) ^ v_load(pb + i + 48);
+    if (!v_none(x))
+      break;
+  }
+
+  for (; i + 16 <= size; i += 16) {
+    if (!v_none(v_load(pa + i) ^ v_load(pb + i)))
+      return i;
+  }
+
+  return i;
+}
+
+/*
+ * Length of the prefix of `p` made of `byte` only
+ */
+static inline long v_run(const void *p, long size, uint8_t byte) {
+  const uint8_t *pb = p;
+  v16_t b = v_splat(byte);
+  long i = 0;
+
+  // 64 bytes per step, one reduction for four lanes of 16
+  for (; i + 64 <= size; i += 64) {
+    v16_t x = v_load(pb + i) ^ b;
+    x |= v_load(pb + i + 16) ^ b;
+    x |= v_load(pb + i + 32) ^ b;
+    x |= v_load(pb + i + 48) ^ b;
+    if (!v_none(x))
+      break;
+  }
+
+  for (; i + 16 <= size; i += 16) {
+    uint32_t mask = v_mask(v_load(pb + i) ^ b);
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+
+  while (i < size && pb[i] == byte)
+    i++;
+  return i;
+}